@@ -4,20 +4,13 @@
 
 #include "hypergraph.h"
 
-typedef struct {
-    int key;
-    int val;
-} pair;
-
 /**
- * Can translate old integers to new integers and vice versa.
+ * Maps the ids of a component back to the ids in the original hypergraph.
  */
 typedef struct
 {
-    int capacity;
     int size;
-    pair *old;
-    pair *new;
+    int *old; // old[new] is the original id of new
 } translation_table;
 
 /**
@@ -26,29 +19,21 @@ typedef struct
 void translation_table_free(translation_table *tt);
 
 /**
- * Sorts the translation table. Call this once before get_old or get_new.
- */
-void sort(translation_table *tt);
-
-/**
- * Returns the old value. Needs O(log n) time. Call sort once before using.
+ * Returns the old value in O(1) time.
  */
 int get_old(translation_table *tt, int new);
 
-/**
- * Returns the new value. Needs O(log n) time. Call sort once before using.
- */
-int get_new(translation_table *tt, int old);
-
 /**
  * Find connected components in a hypergraph
  *
  * @param hg The original hypergraph.
  * @param n_hypergraphs The number of connected components.
+ * @param rows Set to the buffer holding the degrees and rows of every component.
  *
- * @return An array of hypergraphs. The caller is responsible for freeing the memory.
+ * @return An array of hypergraphs, views into rows (see hypergraph_init_view) that no longer depend on hg.
+ * The caller is responsible for freeing the memory, and frees rows after the hypergraphs.
  */
-hypergraph** find_connected_components(hypergraph *hg, int *n_hypergraphs, translation_table ***vertex_tt, translation_table ***edge_tt);
+hypergraph** find_connected_components(hypergraph *hg, int *n_hypergraphs, translation_table ***vertex_tt, translation_table ***edge_tt, int **rows);
 
 /**
  * Determines if the hg consists of multiple non-empty components, but not how many.
@@ -0,0 +1,45 @@
+#pragma once
+
+/*
+    Scratch set over the indices 0 to n - 1 that is cleared in constant time
+
+    Each index stores the epoch it was last added in, and clearing the set starts a new epoch. When
+    the epoch counter wraps around, every mark is reset once, so a stale mark can never match.
+*/
+typedef struct
+{
+    int n;
+    unsigned int epoch;
+    unsigned int *mark;
+} fast_set;
+
+fast_set *fast_set_init(int n);
+
+void fast_set_free(fast_set *s);
+
+// Reset every mark, only needed when the epoch counter wraps around
+void fast_set_reset(fast_set *s);
+
+static inline void fast_set_clear(fast_set *s)
+{
+    if (++s->epoch == 0)
+        fast_set_reset(s);
+}
+
+static inline void fast_set_add(fast_set *s, int i)
+{
+    s->mark[i] = s->epoch;
+}
+
+static inline int fast_set_contains(const fast_set *s, int i)
+{
+    return s->mark[i] == s->epoch;
+}
+
+// Add i, returns 1 if i was not in the set before
+static inline int fast_set_insert(fast_set *s, int i)
+{
+    int r = s->mark[i] != s->epoch;
+    s->mark[i] = s->epoch;
+    return r;
+}
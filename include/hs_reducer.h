@@ -1,6 +1,7 @@
 #pragma once
 
 #include "hypergraph.h"
+#include "fast_set.h"
 
 #include <stdarg.h>
 
@@ -19,8 +20,8 @@ typedef struct
 /*
     Try the reduction from vertex u
     if the reduction is successful, return 1, otherwise 0
-    To test the reductions, the fast_set can be used to avoid local allocations. Note that the fast_sets assume
-    that no value larger than fs_count is written anywhere, so DO NOT write larger values into these arrays.
+    To test the reductions, fs_v and fs_e can be used to avoid local allocations. They are scratch sets over
+    the vertices and the edges, and both are empty at the start of each call.
 
     In the case of a successful reduction, the graph should be updated accordingly
     Additionally:
@@ -29,48 +30,109 @@ typedef struct
         - the c->m should be set to the number of edges that observed a change in their neighborhood
         - the c->E should contain these edges
 */
-typedef int (*hs_func_reduce_graph)(hypergraph *hg, int u, int apply_on_edges, hs_change_list *c, int *fast_set, int fs_count);
+typedef int (*hs_func_reduce_graph)(hypergraph *hg, int u, int apply_on_edges, hs_change_list *c, fast_set *fs_v, fast_set *fs_e);
 
 typedef struct
 {
     hs_func_reduce_graph reduce;
     int global;
+    const char *name;
 } hs_reduction;
 
+// Measurements for one rule, collected by hs_reducer_reduce. Only the timed calls are included in time,
+// which is all calls of a global rule and a sample of the calls of a local rule
+typedef struct
+{
+    long long calls, success;
+    long long timed_calls;
+    double time;
+    long long removed_v, removed_e;
+} hs_reduction_stats;
+
+#define HS_QUEUE_BUCKETS 16
+
+/*
+    Work queue of one rule, for either vertices or edges. Elements are put in a bucket by the log2 of
+    their degree when they are queued, and taken from the lowest non-empty bucket, first in first out.
+*/
+typedef struct
+{
+    int count;
+    unsigned int nonempty; // Bit b is set if bucket b has elements
+    int head[HS_QUEUE_BUCKETS], tail[HS_QUEUE_BUCKETS];
+    int *next; // Lists through the buckets, -1 ends a list
+    int *in;   // Set to 1 if the element is queued
+} hs_queue;
+
 typedef struct
 {
     int n_rules;
     hs_reduction *Rule;
 
-    int *Queue_count, *Queue_front, *Queue_back;
-    int **Queues;
-    int *Queue_count_E, *Queue_front_E, *Queue_back_E;
-    int **Queues_E;
-    int **In_queues, **In_queues_E;
+    hs_queue *Queue, *Queue_E; // Vertex and edge queues of each rule
 
-    int *fast_set;
-    int fs_count;
+    fast_set *fs_v, *fs_e; // Scratch sets passed to the rules
     hs_change_list *c;
 
-    int verbose;
+    hs_reduction_stats *Stats;
+
+    // Vertices and edges removed by each rule and its time, decayed with every call. The rule with queued
+    // work that recently removed the most per second runs next
+    double *Recent_removed, *Recent_time;
+
+    int verbose; // Print the statistics at the end of hs_reducer_reduce
 } hs_reducer;
 
 hs_reducer *hs_reducer_init(hypergraph *g, int n_rules, ...);
 
 void hs_reducer_free(hs_reducer *r);
 
-// void hs_reducer_reduce(hs_reducer *r, hypergraph *g, double tl);
-void hs_reducer_reduce(hs_reducer *r, hypergraph *g);
+// Apply the rules until no rule applies or tl seconds have passed, returns 1 if the graph is fully reduced
+int hs_reducer_reduce(hs_reducer *r, hypergraph *g, double tl);
+
+void hs_reducer_print_stats(hs_reducer *r);
+
+typedef enum
+{
+    HS_REDUCE_WORKLIST, // hs_reducer with the degree one, domination, extended domination, counting, fold, and crown rules
+    HS_REDUCE_SWEEP,    // Repeated full sweeps, see hs_reductions_sweep
+} hs_reduce_mode;
+
+// HS_REDUCE_MODE=sweep selects the sweeps, the worklist reducer is used otherwise
+hs_reduce_mode hs_reducer_mode_from_env();
+
+// Short name of the engine, used to tell kernels of the two engines apart in the kernel cache
+const char *hs_reducer_mode_name(hs_reduce_mode mode);
+
+// Reduce g with the selected engine, verbose prints the rule statistics of the worklist reducer. Returns 1
+// if no rule applies anymore, and 0 if the time limit stopped the reductions first
+int hs_reducer_run(hypergraph *g, hs_reduce_mode mode, double tl, int verbose);
 
 void hs_reducer_queue_changed(hypergraph *g, hs_reducer *r);
 
 int hs_reducer_apply_reduction(hypergraph *g, int u, int apply_on_edges, hs_reduction rule, hs_reducer *r);
 
+/*
+    Reduction log
+
+    Rules whose solution can not be read off the kernel append an entry with hypergraph_log_append.
+    hs_reducer_lift_solution replays the log backwards on HS, where HS[u] is 1 if vertex u is in a
+    hitting set of the kernel, and turns it into a hitting set of the graph before the reductions.
+*/
+enum
+{
+    HS_LOG_FOLD, // u had only the edges {u, v} and {u, w}, w was merged into v and u was left without edges
+    HS_LOG_TYPES,
+};
+
+_Static_assert(HS_LOG_TYPES == HYPERGRAPH_LOG_TYPES, "HYPERGRAPH_LOG_TYPES must match the log entry types");
+
 void hs_reducer_lift_solution(hypergraph *g, int *HS);
 
+// Number of vertices hs_reducer_lift_solution adds to a hitting set of the kernel
+long long hs_reducer_lift_offset(hypergraph *g);
+
 void reducer_queue_all(hs_reducer *r, hypergraph *g);
 
 void hs_reducer_queue_up_neighbors_v(hypergraph *g, int u, hs_change_list *c);
 void hs_reducer_queue_up_neighbors_e(hypergraph *g, int e, hs_change_list *c);
-
-void hs_reducer_reset_fast_set(hypergraph *g, hs_reducer *r);
@@ -5,12 +5,29 @@
 
 int hs_reductions_degree_one_rule(hypergraph *g, double tl);
 
-int hs_reductions_degree_two_rule(hypergraph *g);
+// Remove degree two vertices u where an edge is a subset of the union of the two edges of u, see extended_domination
+int hs_reductions_degree_two_rule(hypergraph *g, double tl);
 
 int hs_reductions_vertex_domination(hypergraph *g, double tl);
 
 int hs_reductions_edge_domination(hypergraph *g, double tl);
 
+/*
+    Parallel domination sweeps. Threads search for dominated vertices or edges in the unchanged graph,
+    and the results are applied afterwards in index order. A result is skipped if its dominating
+    vertex or edge was removed earlier in the same batch.
+*/
+
+int hs_reductions_vertex_domination_parallel(hypergraph *g, double tl);
+
+int hs_reductions_edge_domination_parallel(hypergraph *g, double tl);
+
 int hs_reductions_counting_rule(hypergraph *g);
 
+// Remove every edge identical to an earlier edge, then every vertex identical to an earlier vertex, by hashing the rows
+int hs_reductions_duplicate_rule(hypergraph *g);
+
+// Repeat the degree one, domination, and degree two sweeps until nothing changes
+int hs_reductions_sweep(hypergraph *g, double tl);
+
 graph *hs_reductions_to_mwis(hypergraph *g, int *FM, int max_degree, long long *offset);
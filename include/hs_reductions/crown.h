@@ -0,0 +1,22 @@
+#pragma once
+
+#include "hypergraph.h"
+#include "mwis_reductions.h"
+#include "hs_reducer.h"
+
+/*
+    LP reduction on the edges of size two
+
+    Solves the fractional vertex cover LP of the graph formed by the edges of size two, through a maximum
+    matching in its bipartite double cover. Vertices in an edge of size three or more get the extra
+    constraint x >= 1/2, so only vertices whose every edge has size two can get the value 0. As in the
+    Nemhauser-Trotter theorem, some minimum hitting set contains every vertex with value 1 and none with
+    value 0, so the former are included and the latter are left without edges.
+*/
+int hs_reductions_crown_reduce_graph(hypergraph *g, int u, int apply_on_edges, hs_change_list *c, fast_set *fs_v, fast_set *fs_e);
+
+static hs_reduction crown = {
+    .reduce = hs_reductions_crown_reduce_graph,
+    .global = 1,
+    .name = "crown",
+};
@@ -4,9 +4,10 @@
 #include "mwis_reductions.h"
 #include "hs_reducer.h"
 
-int hs_reductions_degree_one_reduce_graph(hypergraph *g, int u, int apply_on_edges, hs_change_list *c, int *fast_set, int fs_count);
+int hs_reductions_degree_one_reduce_graph(hypergraph *g, int u, int apply_on_edges, hs_change_list *c, fast_set *fs_v, fast_set *fs_e);
 
 static hs_reduction hs_degree_one = {
     .reduce = hs_reductions_degree_one_reduce_graph,
     .global = 0,
+    .name = "degree_one",
 };
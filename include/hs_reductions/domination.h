@@ -4,9 +4,26 @@
 #include "mwis_reductions.h"
 #include "hs_reducer.h"
 
-int hs_reductions_domination_reduce_graph(hypergraph *g, int u, int apply_on_edge, hs_change_list *c, int *fast_set, int fs_count);
+/*
+    Smallest edge or vertex degree up to which the candidates are taken from the pivot row and tested
+    one by one. Beyond it, the candidates come from the degree order if that gives fewer of them, are
+    filtered by degree and signature, and are then intersected with the rows of the other elements, as
+    with the posting lists of an inverted index. The intersection gives up, finding nothing, after
+    HS_DOMINATION_MAX_WORK membership tests.
+*/
+#define HS_DOMINATION_MAX_PIVOT 512
+#define HS_DOMINATION_MAX_WORK (1 << 16)
+
+// Find a vertex other than u that is in every edge of u, where md is the smallest edge of u. Returns -1 if there is none
+int hs_reductions_find_dominating_vertex(hypergraph *g, int u, int md);
+
+// Find an edge other than e that contains e, where md is the vertex of e with the smallest degree. Returns -1 if there is none
+int hs_reductions_find_dominated_edge(hypergraph *g, int e, int md);
+
+int hs_reductions_domination_reduce_graph(hypergraph *g, int u, int apply_on_edge, hs_change_list *c, fast_set *fs_v, fast_set *fs_e);
 
 static hs_reduction domination = {
     .reduce = hs_reductions_domination_reduce_graph,
     .global = 0,
+    .name = "domination",
 };
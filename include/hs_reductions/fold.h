@@ -0,0 +1,20 @@
+#pragma once
+
+#include "hypergraph.h"
+#include "mwis_reductions.h"
+#include "hs_reducer.h"
+
+/*
+    Degree two fold
+
+    A vertex u with only the edges {u, v} and {u, w} is removed with both edges, and w is merged into v.
+    Every hitting set of the result gives one of the original graph with one more vertex, v and w if v
+    was taken and u otherwise, so the fold is recorded in the reduction log.
+*/
+int hs_reductions_fold_reduce_graph(hypergraph *g, int u, int apply_on_edges, hs_change_list *c, fast_set *fs_v, fast_set *fs_e);
+
+static hs_reduction fold = {
+    .reduce = hs_reductions_fold_reduce_graph,
+    .global = 0,
+    .name = "fold",
+};
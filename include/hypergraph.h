@@ -1,16 +1,94 @@
 #pragma once
 
 #include <stdio.h>
+#include <stddef.h>
+
+// Entry in the reduction log, the fields are interpreted by hs_reducer_lift_solution
+typedef struct
+{
+    int type;
+    int u, v, w;
+} hypergraph_log_entry;
+
+// Number of log entry types, which are listed in hs_reducer.h. Snapshots with other types are rejected
+#define HYPERGRAPH_LOG_TYPES 1
 
 typedef struct
 {
     int n, m;
     int *Vd, *Va, *Ed, *Ea;
-    int **V, **E;
+    int **V, **E; // Rows, pointing into the arenas Vb and Eb
+    int *Vb, *Eb;
+    long long Vs, Es; // Used entries of Vb and Eb
+    long long Vc, Ec; // Capacity of Vb and Eb
+    void *map;        // Snapshot mapping backing Vd, Ed, Vb, and Eb, NULL otherwise
+    size_t map_size;
+    int *shared;      // Buffer owned elsewhere backing Vd, Ed, Vb, and Eb, see hypergraph_init_view
+    long long shared_size;
+
+    // Lazy deletion, see hypergraph_lazy_begin
+    int lazy;
+    int *Vl, *El;   // Row lengths including tombstones
+    long long dead; // Total number of tombstones
+
+    long long removed_v, removed_e; // Number of non-empty vertices and edges removed so far
+
+    // Number of changes so far that may have split a component. Removing a vertex in at most one edge,
+    // or an edge with at most one vertex left in other edges, can not, so a graph that was connected
+    // is still connected while this is unchanged
+    long long may_split;
+
+    unsigned long long *Vsig, *Esig; // Row signatures, NULL until hypergraph_build_signatures
+
+    // Degree order, NULL until hypergraph_build_degree_order
+    int *Vo, *Eo;   // Vertices and edges by decreasing degree
+    int *Vod, *Eod; // Degrees at the time of the build, Vod[i] is the degree of Vo[i]
+    int *Vr, *Er;   // Positions in the order, Vo[Vr[u]] == u
+
+    // Reductions that are not plain removals or inclusions, in the order they were applied
+    hypergraph_log_entry *log;
+    long long log_size, log_cap;
 } hypergraph;
 
+// Raw input, either mapped from a regular file or read into one buffer
+typedef struct
+{
+    char *data;
+    size_t size;
+    int mapped;
+} hypergraph_input;
+
+hypergraph_input *hypergraph_input_read(FILE *f);
+
+void hypergraph_input_free(hypergraph_input *in);
+
+unsigned long long hypergraph_input_hash(hypergraph_input *in);
+
+hypergraph *hypergraph_parse_input(hypergraph_input *in);
+
+hypergraph *hypergraph_init(int n, int m);
+
+// Hypergraph over rows in a buffer owned by the caller, which must outlive g. Vd and Ed hold the
+// degrees, and the rows are laid out back to back in Vb and Eb, all inside shared. A row that grows
+// past its place is moved out of shared as usual
+hypergraph *hypergraph_init_view(int n, int m, int *Vd, int *Ed, int *Vb, int *Eb, int *shared, long long shared_size);
+
+// Drop every row, leaving an empty graph with the same n, m, and log
+void hypergraph_free_rows(hypergraph *g);
+
+// Lay out the rows in the arenas, using the degrees in Vd and Ed as row capacities. Resets Vd and Ed to 0
+void hypergraph_init_rows(hypergraph *g);
+
 hypergraph *hypergraph_parse(FILE *f);
 
+hypergraph *hypergraph_parse_buffer(const char *data, size_t size);
+
+// Binary snapshots of sorted hypergraphs, hypergraph_parse also accepts these as input
+
+int hypergraph_write_snapshot(hypergraph *g, const char *path);
+
+hypergraph *hypergraph_load_snapshot(const char *path);
+
 hypergraph *hypergraph_copy(hypergraph *g);
 
 void hypergraph_free(hypergraph *g);
@@ -23,6 +101,100 @@ void hypergraph_remove_edge(hypergraph *g, int e);
 
 void hypergraph_include_vertex(hypergraph *g, int u);
 
+// Add vertex u to edge e, both rows stay sorted
+void hypergraph_add_vertex_to_edge(hypergraph *g, int u, int e);
+
+void hypergraph_log_append(hypergraph *g, int type, int u, int v, int w);
+
+// Make room for at least c entries in a row. May move the arena, so row pointers must be reloaded
+void hypergraph_reserve_vertex(hypergraph *g, int u, int c);
+
+void hypergraph_reserve_edge(hypergraph *g, int e, int c);
+
+/*
+    Lazy deletion
+
+    Between hypergraph_lazy_begin and hypergraph_lazy_end, removals only replace the entry with the
+    tombstone ~id instead of shifting the rest of the row. Vd and Ed still count the live entries,
+    while Vl and El give the full row lengths. A row is free of tombstones if Vl[u] == Vd[u], and
+    must be cleaned with hypergraph_clean_vertex or hypergraph_clean_edge before it is read.
+    Sections can be nested, and all rows are compacted when the outermost section ends.
+*/
+
+void hypergraph_lazy_begin(hypergraph *g);
+
+void hypergraph_lazy_end(hypergraph *g);
+
+void hypergraph_compact_vertex(hypergraph *g, int u);
+
+void hypergraph_compact_edge(hypergraph *g, int e);
+
+void hypergraph_compact(hypergraph *g);
+
+// Compact every row once the tombstones make up a large enough fraction of the graph
+void hypergraph_compact_if_needed(hypergraph *g);
+
+static inline void hypergraph_clean_vertex(hypergraph *g, int u)
+{
+    if (g->lazy > 0 && g->Vl[u] != g->Vd[u])
+        hypergraph_compact_vertex(g, u);
+}
+
+static inline void hypergraph_clean_edge(hypergraph *g, int e)
+{
+    if (g->lazy > 0 && g->El[e] != g->Ed[e])
+        hypergraph_compact_edge(g, e);
+}
+
+/*
+    Row signatures
+
+    The signature of a row has the bit hypergraph_signature_bit(x) set for every entry x. A row can only
+    be a subset of another row if its signature is a subset of the other signature, which rejects most
+    pairs before a full merge. Once built, the modifiers keep the signatures of clean rows up to date.
+*/
+
+void hypergraph_build_signatures(hypergraph *g);
+
+void hypergraph_update_vertex_signature(hypergraph *g, int u);
+
+void hypergraph_update_edge_signature(hypergraph *g, int e);
+
+static inline unsigned long long hypergraph_signature_bit(int x)
+{
+    return 1ull << (((unsigned long long)x * 0x9E3779B97F4A7C15ull) >> 58);
+}
+
+// The rows must be clean
+static inline int hypergraph_vertex_may_be_subset(hypergraph *g, int u, int v)
+{
+    return g->Vsig == NULL || (g->Vsig[u] & ~g->Vsig[v]) == 0;
+}
+
+static inline int hypergraph_edge_may_be_subset(hypergraph *g, int e, int f)
+{
+    return g->Esig == NULL || (g->Esig[e] & ~g->Esig[f]) == 0;
+}
+
+/*
+    Degree order
+
+    Vertices and edges sorted by decreasing degree, for the rules that look for rows at least as large
+    as a given row. Removals only lower degrees, so a prefix of the order still holds every row with a
+    given degree or more, and possibly some rows that have shrunk since. A row that grows in
+    hypergraph_add_vertex_to_edge is moved forward, and the order is rebuilt when the graph is compacted.
+*/
+
+void hypergraph_build_degree_order(hypergraph *g);
+
+void hypergraph_free_degree_order(hypergraph *g);
+
+// Length of the prefix of Vo that holds every vertex with degree at least d
+int hypergraph_vertex_order_prefix(hypergraph *g, int d);
+
+// Length of the prefix of Eo that holds every edge with degree at least d
+int hypergraph_edge_order_prefix(hypergraph *g, int d);
+
 // Utility
 
 void hypergraph_sort(hypergraph *g);
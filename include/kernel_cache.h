@@ -0,0 +1,18 @@
+#pragma once
+
+#include "hypergraph.h"
+
+/*
+    On-disk cache of reduced hypergraphs, enabled by setting HG_KERNEL_CACHE to a directory.
+
+    Entries are keyed by the content hash of the input and the name of the pipeline that produced
+    the kernel, which includes the reduction engine, such as "exact-worklist". The reductions keep the original vertex and edge ids, vertices fixed in the solution
+    remain as degree one vertices with singleton edges, and the snapshot includes the reduction log,
+    so the kernel itself is enough to lift its solution back to the input.
+*/
+
+int kernel_cache_enabled();
+
+hypergraph *kernel_cache_load(unsigned long long key, const char *pipeline);
+
+void kernel_cache_store(unsigned long long key, const char *pipeline, hypergraph *g);
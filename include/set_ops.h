@@ -0,0 +1,76 @@
+#pragma once
+
+/*
+    Set operations on sorted arrays of distinct integers
+
+    Larger inputs go through AVX2 kernels when the CPU supports them, with a scalar fallback chosen
+    at runtime, and small inputs use the scalar merge directly.
+*/
+
+#define SET_OPS_SMALL 16
+
+// Test if A is a subset of B
+int set_ops_subset_large(const int *A, int a, const int *B, int b);
+
+// Test if A and B have no element in common
+int set_ops_disjoint_large(const int *A, int a, const int *B, int b);
+
+// Test if x is in A
+int set_ops_contains(const int *A, int n, int x);
+
+int set_ops_contains_64(const long long *A, long long n, long long x);
+
+// Scalar merges, used directly for small inputs and as the fallback of the vector kernels
+
+static inline int set_ops_subset_scalar(const int *A, int a, const int *B, int b)
+{
+    int i = 0, j = 0;
+    while (i < a && j < b)
+    {
+        if (A[i] == B[j])
+        {
+            i++;
+            j++;
+        }
+        else if (A[i] > B[j])
+        {
+            j++;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    return i == a;
+}
+
+static inline int set_ops_disjoint_scalar(const int *A, int a, const int *B, int b)
+{
+    int i = 0, j = 0;
+    while (i < a && j < b)
+    {
+        if (A[i] == B[j])
+            return 0;
+        int x = A[i], y = B[j];
+        i += x < y;
+        j += y < x;
+    }
+    return 1;
+}
+
+static inline int set_ops_subset(const int *A, int a, const int *B, int b)
+{
+    if (b < a)
+        return 0;
+    if (a > SET_OPS_SMALL)
+        return set_ops_subset_large(A, a, B, b);
+    return set_ops_subset_scalar(A, a, B, b);
+}
+
+static inline int set_ops_disjoint(const int *A, int a, const int *B, int b)
+{
+    if (a > SET_OPS_SMALL && b > SET_OPS_SMALL)
+        return set_ops_disjoint_large(A, a, B, b);
+    return set_ops_disjoint_scalar(A, a, B, b);
+}
@@ -13,6 +13,7 @@ typedef struct
 
     // Graph structures
     int *score, *cover_count, *one_tight;
+    int *tight_edges; // Scratch space for simulated_annealing_one_two_swap
 
     // SA
     long long k;
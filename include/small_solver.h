@@ -0,0 +1,17 @@
+#pragma once
+
+#include "hypergraph.h"
+
+/*
+    Exact hitting set solvers for small or simple instances, which avoid the cost of starting a MaxSAT solver
+
+    Instances whose incidence graph is a forest are solved by dynamic programming over the trees in
+    linear time. Otherwise, instances with at most 64 vertices left are solved by branch and bound on
+    bitmasks, which gives up after SMALL_SOLVER_NODE_LIMIT search nodes.
+*/
+
+#define SMALL_SOLVER_MAX_N 64
+#define SMALL_SOLVER_NODE_LIMIT (1 << 20)
+
+// Same interface as maxsat_solve_hitting_set. Returns -1 without setting res if hg is not handled
+long long small_solver_solve_hitting_set(hypergraph *hg, int **res);
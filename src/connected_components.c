@@ -6,268 +6,190 @@
 void translation_table_free(translation_table *tt) {
     if (!tt) return;
     free(tt->old);
-    free(tt->new);
     free(tt);
 }
 
-// Comparison function for sorting by key
-int compare_by_key(const void *a, const void *b) {
-    const pair *pa = (const pair *) a;
-    const pair *pb = (const pair *) b;
-    return pa->key - pb->key;
+int get_old(translation_table *tt, int new) {
+    return tt->old[new];
 }
 
-void sort(translation_table *tt) {
-    if (tt == NULL || tt->size <= 1)
-        return;
-
-    if (tt->old != NULL) {
-        qsort(tt->old, tt->size, sizeof(pair), compare_by_key);
-    }
-
-    if (tt->new != NULL) {
-        qsort(tt->new, tt->size, sizeof(pair), compare_by_key);
+static inline int find_root(int *parent, int v) {
+    while (parent[v] != v) {
+        parent[v] = parent[parent[v]];
+        v         = parent[v];
     }
+    return v;
 }
 
-int binary_search(pair *arr, int size, int key) {
-    int left = 0, right = size - 1;
-
-    while (left <= right) {
-        int mid = left + (right - left) / 2;
+/**
+ * Labels the components with union-find over the edges, which touches each incidence once. The smaller
+ * root wins every union, so the root of a component is its smallest vertex and the labels come out in
+ * increasing order of the smallest vertex. Vertices without edges are components of their own.
+ *
+ * @return The number of components.
+ */
+static int label_components(hypergraph *hg, int *component_id) {
+    int *parent = (int *) malloc(hg->n * sizeof(int));
+    for (int v = 0; v < hg->n; ++v) { parent[v] = v; }
 
-        if (arr[mid].key == key) {
-            return arr[mid].val;
-        } else if (arr[mid].key < key) {
-            left = mid + 1;
-        } else {
-            right = mid - 1;
+    for (int e = 0; e < hg->m; ++e) {
+        if (hg->Ed[e] == 0) { continue; }
+
+        int r = find_root(parent, hg->E[e][0]);
+        for (int i = 1; i < hg->Ed[e]; ++i) {
+            int s = find_root(parent, hg->E[e][i]);
+            if (s < r) {
+                parent[r] = s;
+                r         = s;
+            } else if (s > r) {
+                parent[s] = r;
+            }
         }
     }
 
-    return -1; // Key not found
-}
-
-int get_old(translation_table *tt, int new) {
-    return binary_search(tt->new, tt->size, new);
-}
-
-int get_new(translation_table *tt, int old) {
-    return binary_search(tt->old, tt->size, old);
-}
-
-hypergraph **find_connected_components(hypergraph *hg, int *n_hypergraphs, translation_table ***vertex_tt, translation_table ***edge_tt) {
-    // Step 1: Determine the number of connected components and for each vertex
-    // determine the corresponding component id
+    // A root comes before the rest of its component, so its label is known when they are reached
     int n_hg = 0;
-
-    int      *component_id = (int *) malloc(hg->n * sizeof(int));
-    for (int v             = 0; v < hg->n; ++v) { component_id[v] = -1; }
-
-    int *bfs_arr     = (int *) malloc(hg->n * sizeof(int));
-    int bfs_arr_size = 0;
-
     for (int v = 0; v < hg->n; ++v) {
-        if (component_id[v] != -1) { continue; }
-
-        int id = n_hg++;
-        bfs_arr[bfs_arr_size++] = v;
-
-        while (bfs_arr_size > 0) {
-            int u = bfs_arr[--bfs_arr_size];
-            // if(component_id[u] != -1 && component_id[u] != -2) { printf("Error\n"); exit(EXIT_FAILURE); }
-
-            component_id[u] = id;
-
-            for (int i = 0; i < hg->Vd[u]; ++i) {
-                int e = hg->V[u][i];
-
-                for (int j = 0; j < hg->Ed[e]; ++j) {
-                    int e_v = hg->E[e][j];
-                    if (component_id[e_v] == -1) {
-                        component_id[e_v]       = -2;
-                        bfs_arr[bfs_arr_size++] = e_v;
-                    }
-                }
-            }
-        }
+        int r = find_root(parent, v);
+        component_id[v] = r == v ? n_hg++ : component_id[r];
     }
 
-    // Step 2: Create each component
-    hypergraph **components = (hypergraph **) malloc(n_hg * sizeof(hypergraph *));
-    for (int   i            = 0; i < n_hg; ++i) {
-        components[i] = (hypergraph *) malloc(sizeof(hypergraph));
-        components[i]->n = 0;
-        components[i]->m = 0;
-    }
+    free(parent);
+    return n_hg;
+}
 
-    // Step 3: Count the number of vertices and edges in each component
+hypergraph **find_connected_components(hypergraph *hg, int *n_hypergraphs, translation_table ***vertex_tt, translation_table ***edge_tt, int **rows) {
+    // Step 1: Determine the number of connected components and for each vertex
+    // determine the corresponding component id
+    int *component_id = (int *) malloc(hg->n * sizeof(int));
+    int n_hg          = label_components(hg, component_id);
+
+    // Step 2: Give each vertex and edge a dense id inside its component, counting them and the size
+    // of their rows on the way. The ids are handed out in increasing order of the old ids, so sorted
+    // rows stay sorted
+    int       *component_n  = (int *) calloc(n_hg, sizeof(int));
+    int       *component_m  = (int *) calloc(n_hg, sizeof(int));
+    long long *component_sv = (long long *) calloc(n_hg, sizeof(long long));
+    long long *component_se = (long long *) calloc(n_hg, sizeof(long long));
+    int       *new_v        = (int *) malloc(hg->n * sizeof(int));
+    int       *new_e        = (int *) malloc(hg->m * sizeof(int));
     for (int v = 0; v < hg->n; ++v) {
-        components[component_id[v]]->n++;
+        int id = component_id[v];
+        new_v[v] = component_n[id]++;
+        component_sv[id] += hg->Vd[v];
     }
     for (int e = 0; e < hg->m; ++e) {
-        if (hg->Ed[e] > 0)
-            components[component_id[hg->E[e][0]]]->m++;
-    }
-
-    // Step 4: Allocate memory for vertices and edges
+        if (hg->Ed[e] == 0) {
+            new_e[e] = -1;
+            continue;
+        }
+        int id = component_id[hg->E[e][0]];
+        new_e[e] = component_m[id]++;
+        component_se[id] += hg->Ed[e];
+    }
+
+    // Step 3: Every component gets one slice of a single buffer, holding its degrees followed by its
+    // vertex and edge rows. base is the start of each slice, and cursor_v and cursor_e are where the
+    // next row of each component goes
+    long long *base     = (long long *) malloc(n_hg * sizeof(long long));
+    long long *cursor_v = (long long *) malloc(n_hg * sizeof(long long));
+    long long *cursor_e = (long long *) malloc(n_hg * sizeof(long long));
+    long long size      = 0;
     for (int i = 0; i < n_hg; ++i) {
-        components[i]->Vd = (int *) malloc(components[i]->n * sizeof(int));
-        components[i]->Va = (int *) malloc(components[i]->n * sizeof(int));
-
-        components[i]->Ed = (int *) malloc(components[i]->m * sizeof(int));
-        components[i]->Ea = (int *) malloc(components[i]->m * sizeof(int));
-
-        components[i]->V = (int **) malloc(components[i]->n * sizeof(int *));
-        components[i]->E = (int **) malloc(components[i]->m * sizeof(int *));
+        base[i]     = size;
+        cursor_v[i] = base[i] + component_n[i] + component_m[i];
+        cursor_e[i] = cursor_v[i] + component_sv[i];
+        size        = cursor_e[i] + component_se[i];
     }
+    // One extra entry keeps the slices of empty components inside the buffer
+    size++;
+    int *buffer = (int *) malloc(size * sizeof(int));
 
-    // Step 5: Allocate memory for translation table
+    // Step 4: Fill the slices and the maps back to the old ids
     translation_table **vertex_translation_tables = (translation_table **) malloc(n_hg * sizeof(translation_table *));
     translation_table **edge_translation_tables   = (translation_table **) malloc(n_hg * sizeof(translation_table *));
-
     for (int i = 0; i < n_hg; ++i) {
-        vertex_translation_tables[i] = (translation_table *) malloc(sizeof(translation_table));
-        vertex_translation_tables[i]->capacity = components[i]->n;
-        vertex_translation_tables[i]->size     = 0;
-        vertex_translation_tables[i]->old      = (pair *) malloc(components[i]->n * sizeof(pair));
-        vertex_translation_tables[i]->new      = (pair *) malloc(components[i]->n * sizeof(pair));
+        vertex_translation_tables[i]       = (translation_table *) malloc(sizeof(translation_table));
+        vertex_translation_tables[i]->size = component_n[i];
+        vertex_translation_tables[i]->old  = (int *) malloc(component_n[i] * sizeof(int));
 
-        edge_translation_tables[i] = (translation_table *) malloc(sizeof(translation_table));
-        edge_translation_tables[i]->capacity = components[i]->m;
-        edge_translation_tables[i]->size     = 0;
-        edge_translation_tables[i]->old      = (pair *) malloc(components[i]->m * sizeof(pair));
-        edge_translation_tables[i]->new      = (pair *) malloc(components[i]->m * sizeof(pair));
+        edge_translation_tables[i]       = (translation_table *) malloc(sizeof(translation_table));
+        edge_translation_tables[i]->size = component_m[i];
+        edge_translation_tables[i]->old  = (int *) malloc(component_m[i] * sizeof(int));
     }
 
-    // Step 6: Fill the vertex translation tables
-    for (int old_v = 0; old_v < hg->n; ++old_v) {
-        int id      = component_id[old_v];
-        int tt_size = vertex_translation_tables[id]->size;
-        int new_v   = tt_size == 0 ? 0 : vertex_translation_tables[id]->old[tt_size - 1].val + 1;
-
-        vertex_translation_tables[id]->old[tt_size].key = old_v;
-        vertex_translation_tables[id]->old[tt_size].val = new_v;
-        vertex_translation_tables[id]->new[tt_size].key = new_v;
-        vertex_translation_tables[id]->new[tt_size].val = old_v;
-        vertex_translation_tables[id]->size++;
-    }
-    for (int i = 0; i < n_hg; ++i) {
-        sort(vertex_translation_tables[i]);
-    }
-
-    // Step 7: Fill the edge translation table
-    for (int old_e = 0; old_e < hg->m; ++old_e) {
-        if (hg->Ed[old_e] > 0) {
-            int id      = component_id[hg->E[old_e][0]];
-            int tt_size = edge_translation_tables[id]->size;
-            int new_e   = tt_size == 0 ? 0 : edge_translation_tables[id]->old[tt_size - 1].val + 1;
+    for (int v = 0; v < hg->n; ++v) {
+        int id   = component_id[v];
+        int *row = buffer + cursor_v[id];
 
-            edge_translation_tables[id]->old[tt_size].key = old_e;
-            edge_translation_tables[id]->old[tt_size].val = new_e;
-            edge_translation_tables[id]->new[tt_size].key = new_e;
-            edge_translation_tables[id]->new[tt_size].val = old_e;
-            edge_translation_tables[id]->size++;
+        vertex_translation_tables[id]->old[new_v[v]] = v;
+        buffer[base[id] + new_v[v]]                   = hg->Vd[v];
+        for (int i = 0; i < hg->Vd[v]; ++i) {
+            row[i] = new_e[hg->V[v][i]];
         }
+        cursor_v[id] += hg->Vd[v];
     }
-    for (int i = 0; i < n_hg; ++i) {
-        sort(edge_translation_tables[i]);
-    }
-
-    // Step 8: Create the hypergraphs
-    for (int old_v = 0; old_v < hg->n; ++old_v) {
-        int id    = component_id[old_v];
-        int new_v = get_new(vertex_translation_tables[id], old_v);
-
-        components[id]->Vd[new_v] = hg->Vd[old_v];
-        components[id]->Va[new_v] = hg->Va[old_v];
-        components[id]->V[new_v]  = (int *) malloc(components[id]->Vd[new_v] * sizeof(int));
-
-        for (int i = 0; i < hg->Vd[old_v]; ++i) {
-            int old_e = hg->V[old_v][i];
-            int new_e = get_new(edge_translation_tables[id], old_e);
-
-            components[id]->V[new_v][i] = new_e;
+    for (int e = 0; e < hg->m; ++e) {
+        if (new_e[e] < 0) { continue; }
+        int id   = component_id[hg->E[e][0]];
+        int *row = buffer + cursor_e[id];
+
+        edge_translation_tables[id]->old[new_e[e]]    = e;
+        buffer[base[id] + component_n[id] + new_e[e]] = hg->Ed[e];
+        for (int i = 0; i < hg->Ed[e]; ++i) {
+            row[i] = new_v[hg->E[e][i]];
         }
+        cursor_e[id] += hg->Ed[e];
     }
 
-    for (int old_e = 0; old_e < hg->m; ++old_e) {
-        if (hg->Ed[old_e] > 0) {
-            int id    = component_id[hg->E[old_e][0]];
-            int new_e = get_new(edge_translation_tables[id], old_e);
-
-            components[id]->Ed[new_e] = hg->Ed[old_e];
-            components[id]->Ea[new_e] = hg->Ea[old_e];
-            components[id]->E[new_e]  = (int *) malloc(components[id]->Ed[new_e] * sizeof(int));
-
-            for (int i = 0; i < hg->Ed[old_e]; ++i) {
-                int old_v = hg->E[old_e][i];
-                int new_v = get_new(vertex_translation_tables[id], old_v);
+    // Step 5: Create the views over the slices
+    hypergraph **components = (hypergraph **) malloc(n_hg * sizeof(hypergraph *));
+    for (int i = 0; i < n_hg; ++i) {
+        int *Vd = buffer + base[i];
+        int *Ed = Vd + component_n[i];
+        int *Vb = Ed + component_m[i];
+        int *Eb = Vb + component_sv[i];
 
-                components[id]->E[new_e][i] = new_v;
-            }
-        }
+        components[i] = hypergraph_init_view(component_n[i], component_m[i], Vd, Ed, Vb, Eb, buffer, size);
     }
 
+    free(component_n);
+    free(component_m);
+    free(component_sv);
+    free(component_se);
+    free(base);
+    free(cursor_v);
+    free(cursor_e);
+
     // free temp memory
     free(component_id);
-    free(bfs_arr);
+    free(new_v);
+    free(new_e);
 
     *n_hypergraphs = n_hg;
     *vertex_tt     = vertex_translation_tables;
     *edge_tt       = edge_translation_tables;
+    *rows          = buffer;
 
     return components;
 }
 
 bool are_multiple_components(hypergraph *hg) {
-    // Step 1: Determine the number of connected components and for each vertex
-    // determine the corresponding component id
-    int n_hg = 0;
-
-    int      *component_id = (int *) malloc(hg->n * sizeof(int));
-    for (int v             = 0; v < hg->n; ++v) { component_id[v] = -1; }
-
-    int *bfs_arr     = (int *) malloc(hg->n * sizeof(int));
-    int bfs_arr_size = 0;
-
-    // put the first non-empty vertex into the queue
-    for (int v = 0; v < hg->n; ++v) {
-        if (hg->Vd[v] > 0) {
-            bfs_arr[bfs_arr_size++] = v;
-            break;
-        }
-    }
+    int *component_id = (int *) malloc(hg->n * sizeof(int));
+    label_components(hg, component_id);
 
-    while (bfs_arr_size > 0) {
-        int u = bfs_arr[--bfs_arr_size];
+    // Every non-empty vertex has to be in the same component as the first one
+    bool multiple = false;
+    int  first    = -1;
+    for (int v = 0; v < hg->n && !multiple; ++v) {
+        if (hg->Vd[v] == 0) { continue; }
 
-        component_id[u] = 0;
-
-        for (int i = 0; i < hg->Vd[u]; ++i) {
-            int e = hg->V[u][i];
-
-            for (int j = 0; j < hg->Ed[e]; ++j) {
-                int e_v = hg->E[e][j];
-                if (component_id[e_v] == -1) {
-                    component_id[e_v]       = -2;
-                    bfs_arr[bfs_arr_size++] = e_v;
-                }
-            }
-        }
-    }
-
-    // for each vertex either it belongs to component 0 or it is empty
-    for (int v = 0; v < hg->n; ++v) {
-        if (!(component_id[v] == 0 || hg->Vd[v] == 0)) {
-
-            free(component_id);
-            free(bfs_arr);
-            return true;
+        if (first < 0) {
+            first = component_id[v];
         }
+        multiple = component_id[v] != first;
     }
 
     free(component_id);
-    free(bfs_arr);
-    return false;
-}
\ No newline at end of file
+    return multiple;
+}
@@ -0,0 +1,28 @@
+#include "fast_set.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+fast_set *fast_set_init(int n)
+{
+    fast_set *s = malloc(sizeof(fast_set));
+    s->n = n;
+    s->mark = malloc(sizeof(unsigned int) * (n > 0 ? n : 1));
+    fast_set_reset(s);
+    return s;
+}
+
+void fast_set_free(fast_set *s)
+{
+    if (s == NULL)
+        return;
+
+    free(s->mark);
+    free(s);
+}
+
+void fast_set_reset(fast_set *s)
+{
+    memset(s->mark, 0, sizeof(unsigned int) * s->n);
+    s->epoch = 1;
+}
@@ -1,9 +1,76 @@
 #include "hypergraph.h"
 #include "hs_reducer.h"
+#include "hs_reductions.h"
+#include "hs_reductions/degree_one.h"
+#include "hs_reductions/domination.h"
+#include "hs_reductions/extended_domination.h"
+#include "hs_reductions/counting_rule.h"
+#include "hs_reductions/crown.h"
+#include "hs_reductions/fold.h"
 
 #include <stdarg.h>
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include <time.h>
+#include <omp.h>
+
+static inline double get_wtime()
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_REALTIME, &tp);
+    return (double)tp.tv_sec + ((double)tp.tv_nsec / 1e9);
+}
+
+static inline int queue_bucket(int d)
+{
+    int b = d > 0 ? 32 - __builtin_clz(d) : 0;
+    return b < HS_QUEUE_BUCKETS ? b : HS_QUEUE_BUCKETS - 1;
+}
+
+static void queue_init(hs_queue *q, int n)
+{
+    q->count = 0;
+    q->nonempty = 0;
+    q->next = malloc(sizeof(int) * n);
+    q->in = calloc(n, sizeof(int));
+}
+
+static void queue_free(hs_queue *q)
+{
+    free(q->next);
+    free(q->in);
+}
+
+static inline void queue_push(hs_queue *q, int x, int d)
+{
+    if (q->in[x])
+        return;
+
+    int b = queue_bucket(d);
+    q->next[x] = -1;
+    if (q->nonempty & (1u << b))
+        q->next[q->tail[b]] = x;
+    else
+        q->head[b] = x;
+    q->tail[b] = x;
+    q->nonempty |= 1u << b;
+    q->in[x] = 1;
+    q->count++;
+}
+
+static inline int queue_pop(hs_queue *q)
+{
+    int b = __builtin_ctz(q->nonempty);
+    int x = q->head[b];
+    if (x == q->tail[b])
+        q->nonempty &= ~(1u << b);
+    else
+        q->head[b] = q->next[x];
+    q->in[x] = 0;
+    q->count--;
+    return x;
+}
 
 hs_reducer *hs_reducer_init(hypergraph *g, int n_rules, ...)
 {
@@ -15,44 +82,27 @@ hs_reducer *hs_reducer_init(hypergraph *g, int n_rules, ...)
 
     r->Rule = malloc(sizeof(hs_reduction) * r->n_rules);
 
-    r->Queue_count = malloc(sizeof(int) * (r->n_rules));
-    r->Queue_front = malloc(sizeof(int) * (r->n_rules));
-    r->Queue_back = malloc(sizeof(int) * (r->n_rules));
-    r->Queue_count_E = malloc(sizeof(int) * (r->n_rules));
-    r->Queue_front_E = malloc(sizeof(int) * (r->n_rules));
-    r->Queue_back_E = malloc(sizeof(int) * (r->n_rules));
-    r->Queues = malloc(sizeof(int *) * (r->n_rules));
-    r->Queues_E = malloc(sizeof(int *) * (r->n_rules));
-    r->In_queues = malloc(sizeof(int *) * (r->n_rules));
-    r->In_queues_E = malloc(sizeof(int *) * (r->n_rules));
+    r->Queue = malloc(sizeof(hs_queue) * r->n_rules);
+    r->Queue_E = malloc(sizeof(hs_queue) * r->n_rules);
+
+    r->fs_v = fast_set_init(g->n);
+    r->fs_e = fast_set_init(g->m);
 
-    r->fast_set = malloc(sizeof(int) * (g->n));
-    r->fs_count = 0;
+    r->Stats = calloc(r->n_rules, sizeof(hs_reduction_stats));
+    r->Recent_removed = calloc(r->n_rules, sizeof(double));
+    r->Recent_time = calloc(r->n_rules, sizeof(double));
+    r->verbose = 0;
 
     for (int i = 0; i < r->n_rules; i++)
     {
-        r->Queue_count[i] = g->n;
-        r->Queue_front[i] = 0;
-        r->Queue_back[i] = 0;
-        r->Queue_count_E[i] = g->m;
-        r->Queue_front_E[i] = 0;
-        r->Queue_back_E[i] = 0;
-        r->Queues[i] = malloc(sizeof(int) * g->n);
-        r->Queues_E[i] = malloc(sizeof(int) * g->m);
-        r->In_queues[i] = malloc(sizeof(int) * g->n);
-        r->In_queues_E[i] = malloc(sizeof(int) * g->m);
+        queue_init(r->Queue + i, g->n);
+        queue_init(r->Queue_E + i, g->m);
 
         // Perhaps make filling the queues optional..
         for (int j = 0; j < g->n; j++)
-        {
-            r->Queues[i][j] = j;
-            r->In_queues[i][j] = 1;
-        }
+            queue_push(r->Queue + i, j, g->Vd[j]);
         for (int j = 0; j < g->m; j++)
-        {
-            r->Queues_E[i][j] = j;
-            r->In_queues_E[i][j] = 1;
-        }
+            queue_push(r->Queue_E + i, j, g->Ed[j]);
     }
 
     r->c = malloc(sizeof(hs_change_list));
@@ -79,28 +129,20 @@ hs_reducer *hs_reducer_init(hypergraph *g, int n_rules, ...)
 
 void hs_reducer_free(hs_reducer *r)
 {
-    free(r->Queue_count);
-    free(r->Queue_front);
-    free(r->Queue_back);
-    free(r->Queue_count_E);
-    free(r->Queue_front_E);
-    free(r->Queue_back_E);
-
     for (int i = 0; i < r->n_rules; i++)
     {
-        free(r->Queues[i]);
-        free(r->In_queues[i]);
-        free(r->Queues_E[i]);
-        free(r->In_queues_E[i]);
+        queue_free(r->Queue + i);
+        queue_free(r->Queue_E + i);
     }
-
-    free(r->Queues);
-    free(r->In_queues);
-    free(r->Queues_E);
-    free(r->In_queues_E);
+    free(r->Queue);
+    free(r->Queue_E);
 
     free(r->Rule);
-    free(r->fast_set);
+    fast_set_free(r->fs_v);
+    fast_set_free(r->fs_e);
+    free(r->Stats);
+    free(r->Recent_removed);
+    free(r->Recent_time);
 
     free(r->c->E);
     free(r->c->V);
@@ -119,15 +161,7 @@ void hs_reducer_queue_changed(hypergraph *g, hs_reducer *r)
         r->c->in_V[v] = 0;
 
         for (int j = 0; j < r->n_rules; j++)
-        {
-            if (!r->In_queues[j][v])
-            {
-                r->Queues[j][r->Queue_back[j]] = v;
-                r->Queue_count[j]++;
-                r->Queue_back[j] = (r->Queue_back[j] + 1) % g->n;
-                r->In_queues[j][v] = 1;
-            }
-        }
+            queue_push(r->Queue + j, v, g->Vd[v]);
     }
     r->c->n = 0;
 
@@ -136,15 +170,7 @@ void hs_reducer_queue_changed(hypergraph *g, hs_reducer *r)
         int e = r->c->E[i];
         r->c->in_E[e] = 0;
         for (int j = 0; j < r->n_rules; j++)
-        {
-            if (!r->In_queues_E[j][e])
-            {
-                r->Queues_E[j][r->Queue_back_E[j]] = e;
-                r->Queue_count_E[j]++;
-                r->Queue_back_E[j] = (r->Queue_back_E[j] + 1) % g->m;
-                r->In_queues_E[j][e] = 1;
-            }
-        }
+            queue_push(r->Queue_E + j, e, g->Ed[e]);
     }
     r->c->m = 0;
 }
@@ -153,6 +179,7 @@ void hs_reducer_queue_up_neighbors_v(hypergraph *g, int u, hs_change_list *c)
 {
     c->n = 0;
     c->m = 0;
+    hypergraph_clean_vertex(g, u);
     for (int i = 0; i < g->Vd[u]; i++)
     {
         int e = g->V[u][i];
@@ -161,6 +188,7 @@ void hs_reducer_queue_up_neighbors_v(hypergraph *g, int u, hs_change_list *c)
             c->E[c->m++] = e;
             c->in_E[e] = 1;
         }
+        hypergraph_clean_edge(g, e);
         for (int j = 0; j < g->Ed[e]; j++)
         {
             int v = g->E[e][j];
@@ -177,6 +205,7 @@ void hs_reducer_queue_up_neighbors_e(hypergraph *g, int e, hs_change_list *c)
 {
     c->n = 0;
     c->m = 0;
+    hypergraph_clean_edge(g, e);
     for (int j = 0; j < g->Ed[e]; j++)
     {
         int v = g->E[e][j];
@@ -185,6 +214,7 @@ void hs_reducer_queue_up_neighbors_e(hypergraph *g, int e, hs_change_list *c)
             c->V[c->n++] = v;
             c->in_V[v] = 1;
         }
+        hypergraph_clean_vertex(g, v);
         for (int i = 0; i < g->Vd[v]; i++)
         {
             int f = g->V[v][i];
@@ -199,11 +229,9 @@ void hs_reducer_queue_up_neighbors_e(hypergraph *g, int e, hs_change_list *c)
 
 int hs_reducer_apply_reduction(hypergraph *g, int u, int apply_on_edges, hs_reduction rule, hs_reducer *r)
 {
-    int res = rule.reduce(g, u, apply_on_edges, r->c, r->fast_set, r->fs_count);
-    r->fs_count++;
-
-    if (r->fs_count == (1 << 30))
-        hs_reducer_reset_fast_set(g, r);
+    fast_set_clear(r->fs_v);
+    fast_set_clear(r->fs_e);
+    int res = rule.reduce(g, u, apply_on_edges, r->c, r->fs_v, r->fs_e);
 
     if (!res)
         return 0;
@@ -213,70 +241,196 @@ int hs_reducer_apply_reduction(hypergraph *g, int u, int apply_on_edges, hs_redu
     return 1;
 }
 
-static inline int dequeue(int *Q, int *F, int *C, int *In, int n)
-{
-    int e = Q[*F];
-    *F = ((*F) + 1) % n;
-    (*C)--;
-    In[e] = 0;
-    return e;
-}
+// Decay of the recent removals and time of a rule per call
+#define HS_RECENT_DECAY 0.999
+
+// Only one in this many calls of a local rule is timed, reading the clock on every call costs about
+// as much as the cheap rules themselves
+#define HS_TIME_SAMPLE 16
 
-// void hs_reducer_reduce(hs_reducer *r, hypergraph *g, double tl)
-void hs_reducer_reduce(hs_reducer *r, hypergraph *g)
+// Queued rule with the most recent removals per second, or -1 if every queue is empty. A rule that
+// has not run yet counts as one removal per microsecond, ties go to the earlier rule. Counting removals
+// rather than successes keeps a rule that removes one edge at a time from beating one that removes a
+// vertex with all its edges. The first rule is expected to be the cheapest and runs whenever it has
+// work, so a later rule never redoes its removals one element at a time. Global rules only run once no
+// local rule has work left
+static int next_rule(hs_reducer *r)
 {
-    int rule = 0;
-    // double t0 = get_wtime();
-    int apply_on_edges = 0;
-    // while (rule < r->n_rules && get_wtime() - t0 < tl)
-    while (rule < r->n_rules)
+    if (!r->Rule[0].global && (r->Queue[0].count > 0 || r->Queue_E[0].count > 0))
+        return 0;
+
+    int best = -1;
+    double best_rate = 0.0;
+    for (int global = 0; global <= 1 && best < 0; global++)
     {
-        if (apply_on_edges == 0 && r->Queue_count[rule] == 0)
+        for (int i = 0; i < r->n_rules; i++)
         {
-            apply_on_edges = 1;
-            continue;
+            if (r->Rule[i].global != global || (r->Queue[i].count == 0 && r->Queue_E[i].count == 0))
+                continue;
+
+            double rate = (r->Recent_removed[i] + 1.0) / (r->Recent_time[i] + 1e-6);
+            if (best < 0 || rate > best_rate)
+            {
+                best = i;
+                best_rate = rate;
+            }
         }
-        if (apply_on_edges == 1 && r->Queue_count_E[rule] == 0)
+    }
+    return best;
+}
+
+int hs_reducer_reduce(hs_reducer *r, hypergraph *g, double tl)
+{
+    double t0 = get_wtime();
+    long long steps = 0;
+
+    if (g->Vsig == NULL)
+        hypergraph_build_signatures(g);
+    hypergraph_lazy_begin(g);
+
+    // The choice is revised after a success, when the rule runs out of work, and every 256 steps
+    int rule = next_rule(r);
+    while (rule >= 0)
+    {
+        if ((++steps & ((1 << 8) - 1)) == 0)
         {
-            apply_on_edges = 0;
-            rule++;
-            continue;
+            if (get_wtime() - t0 > tl)
+                break;
+            rule = next_rule(r);
         }
 
-        int next = 0;
+        hs_queue *qv = r->Queue + rule, *qe = r->Queue_E + rule;
+        int next = 0, apply_on_edges = 0;
         if (r->Rule[rule].global)
         {
-            while (r->Queue_count[rule] > 0)
-            {
-                dequeue(r->Queues[rule], r->Queue_front + rule, r->Queue_count + rule, r->In_queues[rule], g->n);
-            }
-            while (r->Queue_count_E[rule] > 0)
-            {
-                dequeue(r->Queues_E[rule], r->Queue_front_E + rule, r->Queue_count_E + rule, r->In_queues_E[rule], g->m);
-            }
+            while (qv->count > 0)
+                queue_pop(qv);
+            while (qe->count > 0)
+                queue_pop(qe);
         }
         else
         {
-            if (apply_on_edges == 0)
-            {
-                next = dequeue(r->Queues[rule], r->Queue_front + rule, r->Queue_count + rule, r->In_queues[rule], g->n);
-            }
-            else
-            {
-                next = dequeue(r->Queues_E[rule], r->Queue_front_E + rule, r->Queue_count_E + rule, r->In_queues_E[rule], g->m);
-            }
+            // The side with the lower degree bucket goes first
+            apply_on_edges = qv->count == 0 || (qe->count > 0 && __builtin_ctz(qe->nonempty) < __builtin_ctz(qv->nonempty));
+            next = apply_on_edges ? queue_pop(qe) : queue_pop(qv);
         }
 
+        hs_reduction_stats *s = r->Stats + rule;
+        long long rv = g->removed_v, re = g->removed_e;
+        int timed = r->Rule[rule].global || (s->calls % HS_TIME_SAMPLE) == 0;
+        double t1 = timed ? get_wtime() : 0.0;
+
         int res = hs_reducer_apply_reduction(g, next, apply_on_edges, r->Rule[rule], r);
 
+        // The scheduler fills in for the calls that were not timed, the statistics only keep what was measured
+        double dt = 0.0;
+        if (timed)
+        {
+            dt = get_wtime() - t1;
+            s->time += dt;
+            s->timed_calls++;
+            dt *= r->Rule[rule].global ? 1 : HS_TIME_SAMPLE;
+        }
+        s->calls++;
+        s->success += res;
+        s->removed_v += g->removed_v - rv;
+        s->removed_e += g->removed_e - re;
+
+        r->Recent_removed[rule] = r->Recent_removed[rule] * HS_RECENT_DECAY + (g->removed_v - rv) + (g->removed_e - re);
+        r->Recent_time[rule] = r->Recent_time[rule] * HS_RECENT_DECAY + dt;
+
         if (res)
-            rule = 0;
+            hypergraph_compact_if_needed(g);
+        if (res || (qv->count == 0 && qe->count == 0))
+            rule = next_rule(r);
     }
+
+    hypergraph_lazy_end(g);
+
+    if (r->verbose)
+        hs_reducer_print_stats(r);
+
+    return rule < 0;
 }
 
-void hs_reducer_reset_fast_set(hypergraph *g, hs_reducer *r)
+void hs_reducer_print_stats(hs_reducer *r)
 {
-    r->fs_count = 1;
-    for (int i = 0; i < g->n; i++)
-        r->fast_set[i] = 0;
+    for (int i = 0; i < r->n_rules; i++)
+    {
+        hs_reduction_stats *s = r->Stats + i;
+        // time is measured over timed_calls, time_estimate scales it up to all calls
+        double estimate = s->timed_calls > 0 ? s->time * s->calls / s->timed_calls : 0.0;
+        printf("c {\"rule\":\"%s\",\"calls\":%lld,\"success\":%lld,\"timed_calls\":%lld,\"time\":%.4lf,\"time_estimate\":%.4lf,"
+               "\"V_removed\":%lld,\"E_removed\":%lld}\n",
+               r->Rule[i].name != NULL ? r->Rule[i].name : "unnamed", s->calls, s->success, s->timed_calls, s->time, estimate,
+               s->removed_v, s->removed_e);
+    }
+}
+
+hs_reduce_mode hs_reducer_mode_from_env()
+{
+    char *mode = getenv("HS_REDUCE_MODE");
+    if (mode != NULL && strcmp(mode, "sweep") == 0)
+        return HS_REDUCE_SWEEP;
+    return HS_REDUCE_WORKLIST;
+}
+
+const char *hs_reducer_mode_name(hs_reduce_mode mode)
+{
+    return mode == HS_REDUCE_SWEEP ? "sweep" : "worklist";
+}
+
+int hs_reducer_run(hypergraph *g, hs_reduce_mode mode, double tl, int verbose)
+{
+    double t0 = get_wtime();
+    if (mode == HS_REDUCE_SWEEP)
+    {
+        // The sweeps only stop before the time limit once a round changes nothing
+        hs_reductions_sweep(g, tl);
+        return get_wtime() - t0 < tl;
+    }
+
+    // Identical rows are removed in linear time before the pairwise rules see them
+    hs_reductions_duplicate_rule(g);
+
+    // With several threads, one round of parallel sweeps removes most dominated elements up front.
+    // Inside a parallel region, such as a component solved as a task, the sweeps would only get one thread
+    if (omp_get_max_threads() > 1 && !omp_in_parallel())
+    {
+        hs_reductions_degree_one_rule(g, tl);
+        hs_reductions_edge_domination_parallel(g, tl - (get_wtime() - t0));
+        hs_reductions_vertex_domination_parallel(g, tl - (get_wtime() - t0));
+    }
+
+    hs_reducer *r = hs_reducer_init(g, 6, hs_degree_one, domination, extended_domination, counting_rule, fold, crown);
+    r->verbose = verbose;
+    int done = hs_reducer_reduce(r, g, tl - (get_wtime() - t0));
+    hs_reducer_free(r);
+
+    // Same guarantee as the sweeps, no degree one vertices are left behind when time runs out
+    while (!done && hs_reductions_degree_one_rule(g, 10.0) > 0)
+        ;
+    return done;
+}
+
+void hs_reducer_lift_solution(hypergraph *g, int *HS)
+{
+    for (long long i = g->log_size - 1; i >= 0; i--)
+    {
+        hypergraph_log_entry l = g->log[i];
+        if (l.type == HS_LOG_FOLD)
+        {
+            // v stands for both v and w, without it u hits the two removed edges
+            HS[l.w] = HS[l.v];
+            HS[l.u] = !HS[l.v];
+        }
+    }
+}
+
+long long hs_reducer_lift_offset(hypergraph *g)
+{
+    long long r = 0;
+    for (long long i = 0; i < g->log_size; i++)
+        r += g->log[i].type == HS_LOG_FOLD;
+    return r;
 }
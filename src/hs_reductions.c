@@ -1,8 +1,14 @@
 #include "hs_reductions.h"
+#include "hs_reducer.h"
+#include "hs_reductions/extended_domination.h"
+#include "set_ops.h"
+#include "fast_set.h"
 
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <omp.h>
 
 static inline double get_wtime()
 {
@@ -11,48 +17,24 @@ static inline double get_wtime()
     return (double)tp.tv_sec + ((double)tp.tv_nsec / 1e9);
 }
 
-// Test if A is a subset of B
-static inline int test_subset(const int *A, int a, const int *B, int b)
-{
-    if (b < a)
-        return 0;
-
-    int i = 0, j = 0;
-    while (i < a && j < b)
-    {
-        if (A[i] == B[j])
-        {
-            i++;
-            j++;
-        }
-        else if (A[i] > B[j])
-        {
-            j++;
-        }
-        else
-        {
-            return 0;
-        }
-    }
-
-    return i == a;
-}
-
 int hs_reductions_degree_one_rule(hypergraph *g, double tl)
 {
     double t0 = get_wtime();
     int r = 0;
+    hypergraph_lazy_begin(g);
     for (int u = 0; u < g->n; u++)
     {
         if ((u & ((1 << 8) - 1)) == 0)
         {
             if (get_wtime() - t0 > tl)
-                return r;
+                goto done;
+            hypergraph_compact_if_needed(g);
         }
 
         if (g->Vd[u] != 1)
             continue;
 
+        hypergraph_clean_vertex(g, u);
         int e = g->V[u][0];
         if (g->Ed[e] > 1)
         {
@@ -65,12 +47,14 @@ int hs_reductions_degree_one_rule(hypergraph *g, double tl)
         if ((e & ((1 << 8) - 1)) == 0)
         {
             if (get_wtime() - t0 > tl)
-                return r;
+                goto done;
+            hypergraph_compact_if_needed(g);
         }
 
         if (g->Ed[e] != 1)
             continue;
 
+        hypergraph_clean_edge(g, e);
         int u = g->E[e][0];
         if (g->Vd[u] > 1)
         {
@@ -78,91 +62,41 @@ int hs_reductions_degree_one_rule(hypergraph *g, double tl)
             hypergraph_include_vertex(g, u);
         }
     }
+done:
+    hypergraph_lazy_end(g);
     return r;
 }
 
 // assumes domination is checked already (extended domination)
-int hs_reductions_degree_two_rule(hypergraph *g)
+int hs_reductions_degree_two_rule(hypergraph *g, double tl)
 {
-    int r = 0;
-    int *fast_set = malloc(sizeof(int) * g->n);
-    int set_count = 0;
-    for (int i = 0; i < g->n; i++)
-        fast_set[i] = -1;
-
-    for (int u = 0; u < g->n; u++)
-    {
-        if (g->Vd[u] != 2)
-            continue;
-
-        int e1 = g->V[u][0];
-        int e2 = g->V[u][1];
-
-        if (g->Ed[e1] > g->Ed[e2])
-        {
-            e1 = e2;
-            e2 = g->V[u][0];
-        }
-
-        for (int j = 0; j < g->Ed[e1]; j++)
-            fast_set[g->E[e1][j]] = set_count;
-
-        for (int j = 0; j < g->Ed[e2]; j++)
-            fast_set[g->E[e2][j]] = set_count;
-
-        // check edges incident to vertices in smaller edge e1
-        for (int j = 0; j < g->Ed[e1]; j++)
-        {
-            int v = g->E[e1][j];
-            if (v == u)
-                continue;
-
-            for (int k = 0; k < g->Vd[v]; k++)
-            {
-                // potential edge dominated by e1 \cup e2
-                int e = g->V[v][k];
-                if (e == e1 || e == e2)
-                    continue;
-
-                int next = 0;
-                for (int l = 0; l < g->Ed[e]; l++)
-                {
-                    // if there is a vertex not in e1 or in e1, there is no domination
-                    if (fast_set[g->E[e][l]] != set_count)
-                    {
-                        next = 1;
-                        break;
-                    }
-                }
-
-                if (next == 0)
-                {
-                    r++;
-                    hypergraph_remove_vertex(g, u);
-                    break;
-                }
-            }
-        }
-        set_count++;
-    }
-
-    free(fast_set);
-    return r;
+    // The rule is the extended_domination plugin, the reducer starts with every vertex queued and then
+    // only revisits the vertices near a removal
+    hs_reducer *r = hs_reducer_init(g, 1, extended_domination);
+    hs_reducer_reduce(r, g, tl);
+    int res = r->Stats[0].success;
+    hs_reducer_free(r);
+    return res;
 }
 
 int hs_reductions_vertex_domination(hypergraph *g, double tl)
 {
     double t0 = get_wtime();
+    if (g->Vsig == NULL)
+        hypergraph_build_signatures(g);
     int r = 0;
+    hypergraph_lazy_begin(g);
     for (int i = 0; i < g->n; i++)
     {
         if ((i & ((1 << 8) - 1)) == 0)
         {
             if (get_wtime() - t0 > tl)
-                return r;
+                break;
+            hypergraph_compact_if_needed(g);
         }
 
         int md = -1;
+        hypergraph_clean_vertex(g, i);
         for (int j = 0; j < g->Vd[i]; j++)
         {
             int e = g->V[i][j];
@@ -172,13 +106,15 @@ int hs_reductions_vertex_domination(hypergraph *g, double tl)
         if (md < 0)
             continue;
 
+        hypergraph_clean_edge(g, md);
         for (int j = 0; j < g->Ed[md]; j++)
         {
             int v = g->E[md][j];
             if (v == i)
                 continue;
 
-            if (test_subset(g->V[i], g->Vd[i], g->V[v], g->Vd[v]))
+            hypergraph_clean_vertex(g, v);
+            if (hypergraph_vertex_may_be_subset(g, i, v) && set_ops_subset(g->V[i], g->Vd[i], g->V[v], g->Vd[v]))
             {
                 r++;
                 hypergraph_remove_vertex(g, i);
@@ -186,22 +122,28 @@ int hs_reductions_vertex_domination(hypergraph *g, double tl)
             }
         }
     }
+    hypergraph_lazy_end(g);
     return r;
 }
 
 int hs_reductions_edge_domination(hypergraph *g, double tl)
 {
     double t0 = get_wtime();
+    if (g->Esig == NULL)
+        hypergraph_build_signatures(g);
     int r = 0;
+    hypergraph_lazy_begin(g);
     for (int e = 0; e < g->m; e++)
     {
         if ((e & ((1 << 8) - 1)) == 0)
         {
             if (get_wtime() - t0 > tl)
-                return r;
+                break;
+            hypergraph_compact_if_needed(g);
         }
 
         int md = -1;
+        hypergraph_clean_edge(g, e);
         for (int i = 0; i < g->Ed[e]; i++)
         {
             int v = g->E[e][i];
@@ -211,32 +153,203 @@ int hs_reductions_edge_domination(hypergraph *g, double tl)
         if (md < 0) // || g->Vd[md] > 64
             continue;
 
-        for (int i = 0; i < g->Vd[md]; i++)
+        // Removed edges are left as tombstones in V[md], so the row can be scanned in place
+        hypergraph_clean_vertex(g, md);
+        int d = g->Vd[md];
+        for (int i = 0; i < d; i++)
         {
             int e2 = g->V[md][i];
-            if (e2 == e)
+            if (e2 < 0 || e2 == e)
                 continue;
 
-            if (test_subset(g->E[e], g->Ed[e], g->E[e2], g->Ed[e2]))
+            hypergraph_clean_edge(g, e2);
+            if (hypergraph_edge_may_be_subset(g, e, e2) && set_ops_subset(g->E[e], g->Ed[e], g->E[e2], g->Ed[e2]))
             {
                 r++;
                 hypergraph_remove_edge(g, e2);
             }
         }
     }
+    hypergraph_lazy_end(g);
+    return r;
+}
+
+int hs_reductions_vertex_domination_parallel(hypergraph *g, double tl)
+{
+    double t0 = get_wtime();
+    int stop = 0;
+    hypergraph_compact(g);
+    if (g->Vsig == NULL)
+        hypergraph_build_signatures(g);
+
+    // W[u] is a vertex dominating u, or -1
+    int *W = malloc(sizeof(int) * g->n);
+
+#pragma omp parallel for schedule(dynamic, 256)
+    for (int i = 0; i < g->n; i++)
+    {
+        W[i] = -1;
+
+        int s;
+#pragma omp atomic read
+        s = stop;
+        if (s)
+            continue;
+        if ((i & ((1 << 8) - 1)) == 0 && get_wtime() - t0 > tl)
+        {
+#pragma omp atomic write
+            stop = 1;
+        }
+
+        int md = -1;
+        for (int j = 0; j < g->Vd[i]; j++)
+        {
+            int e = g->V[i][j];
+            if (md < 0 || g->Ed[e] < g->Ed[md])
+                md = e;
+        }
+        if (md < 0)
+            continue;
+
+        for (int j = 0; j < g->Ed[md]; j++)
+        {
+            int v = g->E[md][j];
+            if (v == i)
+                continue;
+
+            if (hypergraph_vertex_may_be_subset(g, i, v) && set_ops_subset(g->V[i], g->Vd[i], g->V[v], g->Vd[v]))
+            {
+                W[i] = v;
+                break;
+            }
+        }
+    }
+
+    // Removing vertices leaves the vertex rows unchanged, so V[u] is still a subset of V[W[u]]
+    int r = 0;
+    hypergraph_lazy_begin(g);
+    for (int i = 0; i < g->n; i++)
+    {
+        if (W[i] < 0 || g->Vd[W[i]] == 0)
+            continue;
+
+        r++;
+        hypergraph_remove_vertex(g, i);
+    }
+    hypergraph_lazy_end(g);
+
+    free(W);
+    return r;
+}
+
+static int compare_pair(const void *a, const void *b)
+{
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+int hs_reductions_edge_domination_parallel(hypergraph *g, double tl)
+{
+    double t0 = get_wtime();
+    int stop = 0;
+    hypergraph_compact(g);
+    if (g->Vsig == NULL)
+        hypergraph_build_signatures(g);
+
+    // Pairs (e, e2) with e a subset of e2, packed as e << 32 | e2
+    long long *P = NULL;
+    long long n_pairs = 0;
+
+#pragma omp parallel
+    {
+        long long *L = NULL;
+        long long n = 0, a = 0;
+
+#pragma omp for schedule(dynamic, 256) nowait
+        for (int e = 0; e < g->m; e++)
+        {
+            int s;
+#pragma omp atomic read
+            s = stop;
+            if (s)
+                continue;
+            if ((e & ((1 << 8) - 1)) == 0 && get_wtime() - t0 > tl)
+            {
+#pragma omp atomic write
+                stop = 1;
+            }
+
+            int md = -1;
+            for (int i = 0; i < g->Ed[e]; i++)
+            {
+                int v = g->E[e][i];
+                if (md < 0 || g->Vd[v] < g->Vd[md])
+                    md = v;
+            }
+            if (md < 0)
+                continue;
+
+            for (int i = 0; i < g->Vd[md]; i++)
+            {
+                int e2 = g->V[md][i];
+                if (e2 == e || !hypergraph_edge_may_be_subset(g, e, e2) ||
+                    !set_ops_subset(g->E[e], g->Ed[e], g->E[e2], g->Ed[e2]))
+                    continue;
+
+                if (n == a)
+                {
+                    a = a == 0 ? 64 : a * 2;
+                    L = realloc(L, sizeof(long long) * a);
+                }
+                L[n++] = ((long long)e << 32) | e2;
+            }
+        }
+
+        long long o;
+#pragma omp atomic capture
+        {
+            o = n_pairs;
+            n_pairs += n;
+        }
+#pragma omp barrier
+#pragma omp single
+        P = malloc(sizeof(long long) * (n_pairs > 0 ? n_pairs : 1));
+
+        if (n > 0)
+            memcpy(P + o, L, sizeof(long long) * n);
+        free(L);
+    }
+
+    // Sorting makes the batch independent of the thread schedule
+    qsort(P, n_pairs, sizeof(long long), compare_pair);
+
+    // Removing edges leaves the edge rows unchanged, so E[e] is still a subset of E[e2]
+    int r = 0;
+    hypergraph_lazy_begin(g);
+    for (long long i = 0; i < n_pairs; i++)
+    {
+        int e = P[i] >> 32, e2 = P[i] & 0xFFFFFFFF;
+        if (g->Ed[e] == 0 || g->Ed[e2] == 0)
+            continue;
+
+        r++;
+        hypergraph_remove_edge(g, e2);
+    }
+    hypergraph_lazy_end(g);
+
+    free(P);
     return r;
 }
 
 int hs_reductions_counting_rule(hypergraph *g)
 {
     int r = 0;
-    int *fast_set = malloc(sizeof(int) * g->m);
-    for (int i = 0; i < g->m; i++)
-        fast_set[i] = -1;
+    fast_set *fs = fast_set_init(g->m);
 
     for (int u = 0; u < g->n; u++)
     {
         int c = 0, k = 0;
+        fast_set_clear(fs);
         for (int i = 0; i < g->Vd[u]; i++)
         {
             int e = g->V[u][i];
@@ -253,9 +366,7 @@ int hs_reductions_counting_rule(hypergraph *g)
                 if (e2 == e)
                     continue;
 
-                if (fast_set[e2] != u)
-                    k++;
-                fast_set[e2] = u;
+                k += fast_set_insert(fs, e2);
             }
         }
 
@@ -265,7 +376,154 @@ int hs_reductions_counting_rule(hypergraph *g)
             hypergraph_include_vertex(g, u);
         }
     }
-    free(fast_set);
+    fast_set_free(fs);
+    return r;
+}
+
+typedef struct
+{
+    unsigned long long h;
+    int id;
+} row_hash;
+
+static inline unsigned long long hash_row(const int *A, int n)
+{
+    unsigned long long h = (unsigned long long)n * 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < n; i++)
+    {
+        h = (h ^ (unsigned int)A[i]) * 0xC2B2AE3D27D4EB4Full;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+// Stable LSD radix sort by hash, skipping bytes that are equal in every entry. Returns the buffer holding the result
+static row_hash *radix_sort_hashes(row_hash *A, int n, row_hash *T)
+{
+    int C[256];
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        for (int i = 0; i < 256; i++)
+            C[i] = 0;
+        for (int i = 0; i < n; i++)
+            C[(A[i].h >> shift) & 255]++;
+        if (C[(A[0].h >> shift) & 255] == n)
+            continue;
+
+        int s = 0;
+        for (int i = 0; i < 256; i++)
+        {
+            int t = C[i];
+            C[i] = s;
+            s += t;
+        }
+        for (int i = 0; i < n; i++)
+            T[C[(A[i].h >> shift) & 255]++] = A[i];
+
+        row_hash *X = A;
+        A = T;
+        T = X;
+    }
+    return A;
+}
+
+// Remove all but the first of each set of identical rows in R, returns the number of rows removed
+static int remove_duplicate_rows(hypergraph *g, int **R, int *D, int n, int edges, row_hash *H, row_hash *T)
+{
+    int k = 0;
+    for (int i = 0; i < n; i++)
+        if (D[i] > 0)
+            H[k++].id = i;
+    if (k == 0)
+        return 0;
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int i = 0; i < k; i++)
+        H[i].h = hash_row(R[H[i].id], D[H[i].id]);
+
+    H = radix_sort_hashes(H, k, T);
+
+    int r = 0;
+    for (int i = 0; i < k;)
+    {
+        int j = i + 1;
+        while (j < k && H[j].h == H[i].h)
+            j++;
+
+        // Rows with the same hash are compared to every kept row before them, in case of collisions
+        for (int a = i + 1; a < j; a++)
+        {
+            int x = H[a].id;
+            for (int b = i; b < a; b++)
+            {
+                int y = H[b].id;
+                if (D[y] == 0 || D[x] != D[y] || memcmp(R[x], R[y], sizeof(int) * D[x]) != 0)
+                    continue;
+
+                r++;
+                if (edges)
+                    hypergraph_remove_edge(g, x);
+                else
+                    hypergraph_remove_vertex(g, x);
+                break;
+            }
+        }
+        i = j;
+    }
+    return r;
+}
+
+int hs_reductions_duplicate_rule(hypergraph *g)
+{
+    int s = g->n > g->m ? g->n : g->m;
+    row_hash *H = malloc(sizeof(row_hash) * s);
+    row_hash *T = malloc(sizeof(row_hash) * s);
+
+    hypergraph_lazy_begin(g);
+    hypergraph_compact(g);
+    int r = remove_duplicate_rows(g, g->E, g->Ed, g->m, 1, H, T);
+    hypergraph_compact(g);
+    r += remove_duplicate_rows(g, g->V, g->Vd, g->n, 0, H, T);
+    hypergraph_lazy_end(g);
+
+    free(H);
+    free(T);
+    return r;
+}
+
+int hs_reductions_sweep(hypergraph *g, double tl)
+{
+    double t0 = get_wtime();
+    int parallel = omp_get_max_threads() > 1 && !omp_in_parallel();
+    int r = hs_reductions_duplicate_rule(g), rc = 1;
+    while (rc > 0 && tl > get_wtime() - t0)
+    {
+        rc = 0;
+        rc += hs_reductions_degree_one_rule(g, tl - (get_wtime() - t0));
+        if (parallel)
+        {
+            rc += hs_reductions_edge_domination_parallel(g, tl - (get_wtime() - t0));
+            rc += hs_reductions_vertex_domination_parallel(g, tl - (get_wtime() - t0));
+        }
+        else
+        {
+            rc += hs_reductions_edge_domination(g, tl - (get_wtime() - t0));
+            rc += hs_reductions_vertex_domination(g, tl - (get_wtime() - t0));
+        }
+
+        // The degree two rule revisits its own changes, so it is only needed once the other sweeps stall
+        if (rc == 0)
+            rc += hs_reductions_degree_two_rule(g, tl - (get_wtime() - t0));
+        r += rc;
+    }
+
+    // Always leave the graph without degree one vertices, even if the time limit was hit
+    rc = 1;
+    while (rc > 0)
+    {
+        rc = hs_reductions_degree_one_rule(g, 10.0);
+        r += rc;
+    }
     return r;
 }
 
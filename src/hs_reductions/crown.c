@@ -0,0 +1,263 @@
+#include "hs_reductions/crown.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+// Add the edges of u and their vertices to the change list
+static void add_neighbors(hypergraph *g, int u, hs_change_list *c)
+{
+    hypergraph_clean_vertex(g, u);
+    for (int i = 0; i < g->Vd[u]; i++)
+    {
+        int e = g->V[u][i];
+        if (!c->in_E[e])
+        {
+            c->E[c->m++] = e;
+            c->in_E[e] = 1;
+        }
+        hypergraph_clean_edge(g, e);
+        for (int j = 0; j < g->Ed[e]; j++)
+        {
+            int v = g->E[e][j];
+            if (!c->in_V[v])
+            {
+                c->V[c->n++] = v;
+                c->in_V[v] = 1;
+            }
+        }
+    }
+}
+
+/*
+    Hopcroft-Karp on the bipartite graph with left and right copies of the k vertices, where left i is
+    adjacent to right A[j] for Ai[i] <= j < Ai[i + 1]. The depth first searches use an explicit stack.
+*/
+static void max_matching(int k, const int *Ai, const int *A, int *ML, int *MR)
+{
+    int *D = malloc(sizeof(int) * k);
+    int *Q = malloc(sizeof(int) * k);
+    int *It = malloc(sizeof(int) * k);
+    int *S = malloc(sizeof(int) * k);
+
+    // Greedy start
+    for (int i = 0; i < k; i++)
+        ML[i] = MR[i] = -1;
+    for (int i = 0; i < k; i++)
+    {
+        for (int j = Ai[i]; j < Ai[i + 1] && ML[i] < 0; j++)
+        {
+            if (MR[A[j]] < 0)
+            {
+                ML[i] = A[j];
+                MR[A[j]] = i;
+            }
+        }
+    }
+
+    while (1)
+    {
+        int qb = 0, qe = 0, found = 0;
+        for (int i = 0; i < k; i++)
+        {
+            D[i] = -1;
+            if (ML[i] < 0)
+            {
+                D[i] = 0;
+                Q[qe++] = i;
+            }
+        }
+        while (qb < qe)
+        {
+            int u = Q[qb++];
+            for (int j = Ai[u]; j < Ai[u + 1]; j++)
+            {
+                int w = MR[A[j]];
+                if (w < 0)
+                    found = 1;
+                else if (D[w] < 0)
+                {
+                    D[w] = D[u] + 1;
+                    Q[qe++] = w;
+                }
+            }
+        }
+        if (!found)
+            break;
+
+        for (int i = 0; i < k; i++)
+            It[i] = Ai[i];
+
+        for (int i = 0; i < k; i++)
+        {
+            if (ML[i] >= 0)
+                continue;
+
+            int sp = 0;
+            S[sp++] = i;
+            while (sp > 0)
+            {
+                int u = S[sp - 1];
+                if (It[u] == Ai[u + 1])
+                {
+                    D[u] = -1;
+                    sp--;
+                    continue;
+                }
+
+                int w = MR[A[It[u]]];
+                if (w < 0)
+                {
+                    // Flip the augmenting path along the stack
+                    for (int t = sp - 1; t >= 0; t--)
+                    {
+                        int x = S[t], v = A[It[x]];
+                        ML[x] = v;
+                        MR[v] = x;
+                    }
+                    break;
+                }
+                if (D[w] == D[u] + 1)
+                    S[sp++] = w;
+                else
+                    It[u]++;
+            }
+        }
+    }
+
+    free(D);
+    free(Q);
+    free(It);
+    free(S);
+}
+
+int hs_reductions_crown_reduce_graph(hypergraph *g, int ue, int apply_on_edges, hs_change_list *c, fast_set *fs_v, fast_set *fs_e)
+{
+    c->n = 0;
+    c->m = 0;
+
+    // Local ids for the vertices in an edge of size two, impure vertices also have larger edges and are marked in fs_v
+    int *id = malloc(sizeof(int) * g->n);
+    int k = 0;
+    for (int u = 0; u < g->n; u++)
+    {
+        id[u] = -1;
+        if (g->Vd[u] == 0)
+            continue;
+
+        int two = 0;
+        hypergraph_clean_vertex(g, u);
+        for (int i = 0; i < g->Vd[u]; i++)
+        {
+            if (g->Ed[g->V[u][i]] == 2)
+                two = 1;
+            else
+                fast_set_add(fs_v, u);
+        }
+        if (two)
+            id[u] = k++;
+    }
+
+    if (k == 0)
+    {
+        free(id);
+        return 0;
+    }
+
+    int *R = malloc(sizeof(int) * k);
+    int *Ai = calloc(k + 1, sizeof(int));
+    for (int u = 0; u < g->n; u++)
+    {
+        if (id[u] < 0)
+            continue;
+
+        R[id[u]] = u;
+        Ai[id[u] + 1] = fast_set_contains(fs_v, u);
+        for (int i = 0; i < g->Vd[u]; i++)
+            Ai[id[u] + 1] += g->Ed[g->V[u][i]] == 2;
+    }
+    for (int i = 0; i < k; i++)
+        Ai[i + 1] += Ai[i];
+
+    // The self loop of an impure vertex is the constraint 2x >= 1
+    int *A = malloc(sizeof(int) * Ai[k]);
+    for (int i = 0; i < k; i++)
+    {
+        int u = R[i], p = Ai[i];
+        if (fast_set_contains(fs_v, u))
+            A[p++] = i;
+        for (int j = 0; j < g->Vd[u]; j++)
+        {
+            int e = g->V[u][j];
+            if (g->Ed[e] != 2)
+                continue;
+
+            hypergraph_clean_edge(g, e);
+            A[p++] = id[g->E[e][0] == u ? g->E[e][1] : g->E[e][0]];
+        }
+    }
+
+    int *ML = malloc(sizeof(int) * k);
+    int *MR = malloc(sizeof(int) * k);
+    max_matching(k, Ai, A, ML, MR);
+
+    // Konig, the alternating paths from free left copies reach ZL and ZR. The minimum cover is the
+    // left copies outside ZL and the right copies in ZR, and x is the average over the two copies
+    int *ZL = calloc(k, sizeof(int));
+    int *ZR = calloc(k, sizeof(int));
+    int *Q = malloc(sizeof(int) * k);
+    int qb = 0, qe = 0;
+    for (int i = 0; i < k; i++)
+    {
+        if (ML[i] < 0)
+        {
+            ZL[i] = 1;
+            Q[qe++] = i;
+        }
+    }
+    while (qb < qe)
+    {
+        int x = Q[qb++];
+        for (int j = Ai[x]; j < Ai[x + 1]; j++)
+        {
+            int v = A[j];
+            if (ZR[v])
+                continue;
+
+            ZR[v] = 1;
+            int w = MR[v];
+            assert(w >= 0);
+            if (!ZL[w])
+            {
+                ZL[w] = 1;
+                Q[qe++] = w;
+            }
+        }
+    }
+
+    int res = 0;
+    for (int i = 0; i < k; i++)
+    {
+        int u = R[i];
+        if (ZL[i] || !ZR[i] || g->Vd[u] == 0)
+            continue;
+
+        res = 1;
+        add_neighbors(g, u, c);
+        hypergraph_include_vertex(g, u);
+    }
+
+    // Every edge of a vertex with value 0 went to a vertex with value 1
+    for (int i = 0; i < k; i++)
+        assert(!ZL[i] || ZR[i] || g->Vd[R[i]] == 0);
+
+    free(id);
+    free(R);
+    free(Ai);
+    free(A);
+    free(ML);
+    free(MR);
+    free(ZL);
+    free(ZR);
+    free(Q);
+    return res;
+}
\ No newline at end of file
@@ -3,7 +3,7 @@
 #include <assert.h>
 #include <stdlib.h>
 
-int hs_reductions_degree_one_reduce_graph(hypergraph *g, int ue, int apply_on_edges, hs_change_list *c, int *fast_set, int fs_count)
+int hs_reductions_degree_one_reduce_graph(hypergraph *g, int ue, int apply_on_edges, hs_change_list *c, fast_set *fs_v, fast_set *fs_e)
 {
     if (apply_on_edges)
     {
@@ -11,6 +11,7 @@ int hs_reductions_degree_one_reduce_graph(hypergraph *g, int ue, int apply_on_ed
         if (g->Ed[e] != 1)
             return 0;
 
+        hypergraph_clean_edge(g, e);
         int u = g->E[e][0];
         if (g->Vd[u] > 1)
         {
@@ -25,6 +26,7 @@ int hs_reductions_degree_one_reduce_graph(hypergraph *g, int ue, int apply_on_ed
     if (g->Vd[u] != 1)
         return 0;
 
+    hypergraph_clean_vertex(g, u);
     int e = g->V[u][0];
     if (g->Ed[e] > 1)
     {
@@ -1,91 +1,186 @@
 #include "hs_reductions/domination.h"
+#include "set_ops.h"
 
 #include <assert.h>
 #include <stdlib.h>
 
-// Test if A is a subset of B
-static inline int test_subset(const int *A, int a, const int *B, int b)
+// Keep the candidates in C that are in the sorted row R, returns how many are left
+static int filter_candidates(int *C, int c, const int *R, int r)
 {
-    if (b < a)
-        return 0;
+    int k = 0;
+    for (int i = 0; i < c; i++)
+    {
+        C[k] = C[i];
+        k += set_ops_contains(R, r, C[i]);
+    }
+    return k;
+}
 
-    int i = 0, j = 0;
-    while (i < a && j < b)
+int hs_reductions_find_dominating_vertex(hypergraph *g, int u, int md)
+{
+    if (g->Ed[md] <= HS_DOMINATION_MAX_PIVOT)
     {
-        if (A[i] == B[j])
-        {
-            i++;
-            j++;
-        }
-        else if (A[i] > B[j])
+        hypergraph_clean_edge(g, md);
+        for (int j = 0; j < g->Ed[md]; j++)
         {
-            j++;
+            int v = g->E[md][j];
+            if (v == u)
+                continue;
+
+            hypergraph_clean_vertex(g, v);
+            if (hypergraph_vertex_may_be_subset(g, u, v) && set_ops_subset(g->V[u], g->Vd[u], g->V[v], g->Vd[v]))
+                return v;
         }
-        else
+        return -1;
+    }
+
+    // Only vertices with degree at least Vd[u] can dominate u, start from those if there are fewer of them than in md
+    if (g->Vo == NULL)
+        hypergraph_build_degree_order(g);
+    hypergraph_clean_vertex(g, u);
+    hypergraph_clean_edge(g, md);
+    const int *S = g->Vo;
+    int s = hypergraph_vertex_order_prefix(g, g->Vd[u]);
+    if (s > g->Ed[md])
+    {
+        S = g->E[md];
+        s = g->Ed[md];
+    }
+
+    // The signature of a row with tombstones only has extra bits, so it can be tested before cleaning
+    int *C = malloc(sizeof(int) * (s > 0 ? s : 1));
+    int c = 0;
+    for (int j = 0; j < s; j++)
+    {
+        int v = S[j];
+        if (v != u && g->Vd[v] >= g->Vd[u] && hypergraph_vertex_may_be_subset(g, u, v))
+            C[c++] = v;
+    }
+
+    // A dominating vertex is in every edge of u, so the candidates are intersected with the edges of u
+    int j = 0;
+    long long work = 0;
+    for (; j < g->Vd[u] && c > 0; j++)
+    {
+        int e = g->V[u][j];
+        if (e == md && S != g->Vo)
+            continue;
+
+        work += c;
+        if (work > HS_DOMINATION_MAX_WORK)
+            break;
+
+        hypergraph_clean_edge(g, e);
+        c = filter_candidates(C, c, g->E[e], g->Ed[e]);
+    }
+
+    int v = j == g->Vd[u] && c > 0 ? C[0] : -1;
+    free(C);
+    return v;
+}
+
+int hs_reductions_find_dominated_edge(hypergraph *g, int e, int md)
+{
+    if (g->Vd[md] <= HS_DOMINATION_MAX_PIVOT)
+    {
+        hypergraph_clean_vertex(g, md);
+        for (int i = 0; i < g->Vd[md]; i++)
         {
-            return 0;
+            int e2 = g->V[md][i];
+            if (e2 == e)
+                continue;
+
+            hypergraph_clean_edge(g, e2);
+            if (hypergraph_edge_may_be_subset(g, e, e2) && set_ops_subset(g->E[e], g->Ed[e], g->E[e2], g->Ed[e2]))
+                return e2;
         }
+        return -1;
+    }
+
+    // Only edges with degree at least Ed[e] can contain e, start from those if there are fewer of them than in md
+    if (g->Vo == NULL)
+        hypergraph_build_degree_order(g);
+    hypergraph_clean_edge(g, e);
+    hypergraph_clean_vertex(g, md);
+    const int *S = g->Eo;
+    int s = hypergraph_edge_order_prefix(g, g->Ed[e]);
+    if (s > g->Vd[md])
+    {
+        S = g->V[md];
+        s = g->Vd[md];
+    }
+
+    int *C = malloc(sizeof(int) * (s > 0 ? s : 1));
+    int c = 0;
+    for (int i = 0; i < s; i++)
+    {
+        int e2 = S[i];
+        if (e2 != e && g->Ed[e2] >= g->Ed[e] && hypergraph_edge_may_be_subset(g, e, e2))
+            C[c++] = e2;
+    }
+
+    // An edge containing e is in the row of every vertex of e
+    int i = 0;
+    long long work = 0;
+    for (; i < g->Ed[e] && c > 0; i++)
+    {
+        int v = g->E[e][i];
+        if (v == md && S != g->Eo)
+            continue;
+
+        work += c;
+        if (work > HS_DOMINATION_MAX_WORK)
+            break;
+
+        hypergraph_clean_vertex(g, v);
+        c = filter_candidates(C, c, g->V[v], g->Vd[v]);
     }
 
-    return i == a;
+    int e2 = i == g->Ed[e] && c > 0 ? C[0] : -1;
+    free(C);
+    return e2;
 }
 
-int hs_reductions_domination_reduce_graph(hypergraph *g, int ue, int apply_on_edges, hs_change_list *c, int *fast_set, int fs_count)
+int hs_reductions_domination_reduce_graph(hypergraph *g, int ue, int apply_on_edges, hs_change_list *c, fast_set *fs_v, fast_set *fs_e)
 {
     if (apply_on_edges == 0)
     {
         // vertex domination
         int u = ue;
         int md = -1;
+        hypergraph_clean_vertex(g, u);
         for (int j = 0; j < g->Vd[u]; j++)
         {
             int e = g->V[u][j];
             if (md < 0 || g->Ed[e] < g->Ed[md])
                 md = e;
         }
-        if (md < 0 || g->Ed[md] > 512) // (1 << 10)
+        if (md < 0 || hs_reductions_find_dominating_vertex(g, u, md) < 0)
             return 0;
 
-        for (int j = 0; j < g->Ed[md]; j++)
-        {
-            int v = g->E[md][j];
-            if (v == u)
-                continue;
-
-            if (test_subset(g->V[u], g->Vd[u], g->V[v], g->Vd[v]))
-            {
-                hs_reducer_queue_up_neighbors_v(g, u, c);
-                hypergraph_remove_vertex(g, u);
-                return 1;
-            }
-        }
-        return 0;
+        hs_reducer_queue_up_neighbors_v(g, u, c);
+        hypergraph_remove_vertex(g, u);
+        return 1;
     }
 
     // edge domination
     int e = ue;
     int md = -1;
+    hypergraph_clean_edge(g, e);
     for (int i = 0; i < g->Ed[e]; i++)
     {
         int v = g->E[e][i];
         if (md < 0 || g->Vd[v] < g->Vd[md])
             md = v;
     }
-    if (md < 0 || g->Vd[md] > 512) // (1 << 10)
+    if (md < 0)
         return 0;
 
-    for (int i = 0; i < g->Vd[md]; i++)
-    {
-        int e2 = g->V[md][i];
-        if (e2 == e)
-            continue;
+    int e2 = hs_reductions_find_dominated_edge(g, e, md);
+    if (e2 < 0)
+        return 0;
 
-        if (test_subset(g->E[e], g->Ed[e], g->E[e2], g->Ed[e2]))
-        {
-            hs_reducer_queue_up_neighbors_e(g, e2, c);
-            hypergraph_remove_edge(g, e2);
-            return 1;
-        }
-    }
-    return 0;
+    hs_reducer_queue_up_neighbors_e(g, e2, c);
+    hypergraph_remove_edge(g, e2);
+    return 1;
 }
\ No newline at end of file
@@ -3,7 +3,7 @@
 #include <assert.h>
 #include <stdlib.h>
 
-int hs_reductions_extended_domination_reduce_graph(hypergraph *g, int ue, int apply_on_edges, hs_change_list *c, int *fast_set, int fs_count)
+int hs_reductions_extended_domination_reduce_graph(hypergraph *g, int ue, int apply_on_edges, hs_change_list *c, fast_set *fs_v, fast_set *fs_e)
 {
     if (apply_on_edges == 1)
         return 0;
@@ -12,6 +12,7 @@ int hs_reductions_extended_domination_reduce_graph(hypergraph *g, int ue, int ap
     if (g->Vd[u] != 2)
         return 0;
 
+    hypergraph_clean_vertex(g, u);
     int e1 = g->V[u][0];
     int e2 = g->V[u][1];
 
@@ -21,11 +22,14 @@ int hs_reductions_extended_domination_reduce_graph(hypergraph *g, int ue, int ap
         e2 = g->V[u][0];
     }
 
+    hypergraph_clean_edge(g, e1);
+    hypergraph_clean_edge(g, e2);
+
     for (int j = 0; j < g->Ed[e1]; j++)
-        fast_set[g->E[e1][j]] = fs_count;
+        fast_set_add(fs_v, g->E[e1][j]);
 
     for (int j = 0; j < g->Ed[e2]; j++)
-        fast_set[g->E[e2][j]] = fs_count;
+        fast_set_add(fs_v, g->E[e2][j]);
 
     // check edges incident to vertices in smaller edge e1
     for (int j = 0; j < g->Ed[e1]; j++)
@@ -34,6 +38,7 @@ int hs_reductions_extended_domination_reduce_graph(hypergraph *g, int ue, int ap
         if (v == u)
             continue;
 
+        hypergraph_clean_vertex(g, v);
         for (int k = 0; k < g->Vd[v]; k++)
         {
             // potential edge dominated by e1 \cup e2
@@ -41,11 +46,12 @@ int hs_reductions_extended_domination_reduce_graph(hypergraph *g, int ue, int ap
             if (e == e1 || e == e2)
                 continue;
 
+            hypergraph_clean_edge(g, e);
             int next = 0;
             for (int l = 0; l < g->Ed[e]; l++)
             {
                 // if there is a vertex not in e1 or in e1, there is no domination
-                if (fast_set[g->E[e][l]] != fs_count)
+                if (!fast_set_contains(fs_v, g->E[e][l]))
                 {
                     next = 1;
                     break;
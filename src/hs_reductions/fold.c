@@ -0,0 +1,46 @@
+#include "hs_reductions/fold.h"
+#include "set_ops.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+int hs_reductions_fold_reduce_graph(hypergraph *g, int ue, int apply_on_edges, hs_change_list *c, fast_set *fs_v, fast_set *fs_e)
+{
+    if (apply_on_edges == 1)
+        return 0;
+
+    int u = ue;
+    if (g->Vd[u] != 2)
+        return 0;
+
+    hypergraph_clean_vertex(g, u);
+    int e1 = g->V[u][0];
+    int e2 = g->V[u][1];
+    if (g->Ed[e1] != 2 || g->Ed[e2] != 2)
+        return 0;
+
+    hypergraph_clean_edge(g, e1);
+    hypergraph_clean_edge(g, e2);
+    int v = g->E[e1][0] == u ? g->E[e1][1] : g->E[e1][0];
+    int w = g->E[e2][0] == u ? g->E[e2][1] : g->E[e2][0];
+    if (v == w)
+        return 0;
+
+    hypergraph_remove_edge(g, e1);
+    hypergraph_remove_edge(g, e2);
+
+    // Every edge of w gets v, unless it already has it. Adding to an edge never touches V[w]
+    hypergraph_clean_vertex(g, w);
+    for (int i = 0; i < g->Vd[w]; i++)
+    {
+        int e = g->V[w][i];
+        hypergraph_clean_edge(g, e);
+        if (!set_ops_contains(g->E[e], g->Ed[e], v))
+            hypergraph_add_vertex_to_edge(g, v, e);
+    }
+    hypergraph_remove_vertex(g, w);
+
+    hypergraph_log_append(g, HS_LOG_FOLD, u, v, w);
+    hs_reducer_queue_up_neighbors_v(g, v, c);
+    return 1;
+}
\ No newline at end of file
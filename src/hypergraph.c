@@ -4,53 +4,95 @@
 #include <assert.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <omp.h>
 
 #define MIN_ALLOC 8
+#define PARALLEL_PARSE_MIN_SIZE (1 << 24)
+#define SORT_INSERTION_MAX 32
+#define HYPERGRAPH_SNAPSHOT_VERSION 2
 
-static inline void skip_comments(FILE *f)
+typedef struct
 {
-    int c = fgetc_unlocked(f);
-    while (c == 'c')
+    const char *p, *end;
+} hypergraph_reader;
+
+static inline void skip_comments(hypergraph_reader *r)
+{
+    while (r->p < r->end && *r->p == 'c')
     {
-        while (c != '\n')
-            c = fgetc_unlocked(f);
-        c = fgetc_unlocked(f);
+        const char *nl = memchr(r->p, '\n', r->end - r->p);
+        r->p = nl == NULL ? r->end : nl + 1;
     }
-    ungetc(c, f);
 }
 
-static inline void skip_line(FILE *f)
+static inline void skip_line(hypergraph_reader *r)
 {
-    int c = fgetc_unlocked(f);
-    while (c != '\n')
-        c = fgetc_unlocked(f);
+    const char *nl = memchr(r->p, '\n', r->end - r->p);
+    r->p = nl == NULL ? r->end : nl + 1;
 }
 
-static inline void parse_unsigned_int(FILE *f, int *v)
+static inline int is_digit(char c)
 {
-    int c = fgetc_unlocked(f);
-    while ((c < '0' || c > '9') && c != '\n')
-        c = fgetc_unlocked(f);
+    return (unsigned char)(c - '0') < 10;
+}
 
-    *v = -1;
-    if (c == '\n')
+// Parse the digits starting at p, eight characters at a time when possible
+static inline const char *parse_digits(const char *p, const char *end, int *v)
+{
+    unsigned long long x = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    static const unsigned long long pow10[9] = {1ull, 10ull, 100ull, 1000ull, 10000ull,
+                                                100000ull, 1000000ull, 10000000ull, 100000000ull};
+    while (end - p >= 8)
     {
-        ungetc(c, f);
-        return;
+        unsigned long long w;
+        memcpy(&w, p, sizeof(w));
+
+        // Non-zero bytes in nd mark characters outside '0'-'9'
+        unsigned long long nd = ((w & 0xF0F0F0F0F0F0F0F0ull) |
+                                 (((w + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) ^
+                                0x3333333333333333ull;
+        int k = nd ? __builtin_ctzll(nd) >> 3 : 8;
+        if (k == 0)
+            break;
+
+        // Shift in leading zeros and combine the digits pairwise
+        w <<= 8 * (8 - k);
+        w = ((w & 0x0F0F0F0F0F0F0F0Full) * 2561) >> 8;
+        w = ((w & 0x00FF00FF00FF00FFull) * 6553601) >> 16;
+        w = ((w & 0x0000FFFF0000FFFFull) * 42949672960001ull) >> 32;
+
+        x = x * pow10[k] + w;
+        p += k;
+        if (k < 8)
+        {
+            *v = (int)x;
+            return p;
+        }
     }
+#endif
+    while (p < end && is_digit(*p))
+        x = (x * 10) + (*p++ - '0');
 
-    *v = 0;
-    while (c >= '0' && c <= '9')
-    {
-        *v = (*v * 10) + (c - '0');
-        c = fgetc_unlocked(f);
-    }
-    ungetc(c, f);
+    *v = (int)x;
+    return p;
 }
 
-static inline int hypergraph_compare(const void *a, const void *b)
+static inline void parse_unsigned_int(hypergraph_reader *r, int *v)
 {
-    return (*(int *)a - *(int *)b);
+    const char *p = r->p;
+    while (p < r->end && !is_digit(*p) && *p != '\n')
+        p++;
+
+    *v = -1;
+    if (p == r->end || *p == '\n')
+    {
+        r->p = p;
+        return;
+    }
+
+    r->p = parse_digits(p, r->end, v);
 }
 
 static inline int lower_bound(const int *A, int n, int x)
@@ -66,215 +108,947 @@ static inline int lower_bound(const int *A, int n, int x)
     return s - A;
 }
 
-void hypergraph_append_element(int *l, int *a, int **A, int v)
+static inline unsigned long long row_signature(const int *A, int n)
 {
-    if (*l >= *a)
-    {
-        *a *= 2;
-        *A = realloc(*A, sizeof(int) * *a);
-    }
-    (*A)[(*l)++] = v;
+    unsigned long long s = 0;
+    for (int i = 0; i < n; i++)
+        s |= hypergraph_signature_bit(A[i]);
+    return s;
 }
 
-hypergraph *hypergraph_init(int n, int m)
+// Everything but Vd and Ed, with no rows
+static hypergraph *hypergraph_init_shell(int n, int m)
 {
     hypergraph *g = malloc(sizeof(hypergraph));
     g->n = n;
     g->m = m;
 
-    g->Vd = malloc(sizeof(int) * n);
     g->Va = malloc(sizeof(int) * n);
-
-    g->Ed = malloc(sizeof(int) * m);
     g->Ea = malloc(sizeof(int) * m);
 
     g->V = malloc(sizeof(int *) * n);
     g->E = malloc(sizeof(int *) * m);
 
+    g->Vb = NULL;
+    g->Eb = NULL;
+    g->Vs = 0;
+    g->Es = 0;
+    g->Vc = 0;
+    g->Ec = 0;
+    g->map = NULL;
+    g->map_size = 0;
+    g->shared = NULL;
+    g->shared_size = 0;
+
+    g->lazy = 0;
+    g->Vl = NULL;
+    g->El = NULL;
+    g->dead = 0;
+
+    g->removed_v = 0;
+    g->removed_e = 0;
+    g->may_split = 0;
+
+    g->Vsig = NULL;
+    g->Esig = NULL;
+
+    g->Vo = NULL;
+    g->Eo = NULL;
+    g->Vod = NULL;
+    g->Eod = NULL;
+    g->Vr = NULL;
+    g->Er = NULL;
+
+    g->log = NULL;
+    g->log_size = 0;
+    g->log_cap = 0;
+
+    return g;
+}
+
+hypergraph *hypergraph_init(int n, int m)
+{
+    hypergraph *g = hypergraph_init_shell(n, m);
+    g->Vd = calloc(n, sizeof(int));
+    g->Ed = calloc(m, sizeof(int));
+    return g;
+}
+
+hypergraph *hypergraph_init_view(int n, int m, int *Vd, int *Ed, int *Vb, int *Eb, int *shared, long long shared_size)
+{
+    hypergraph *g = hypergraph_init_shell(n, m);
+    g->Vd = Vd;
+    g->Ed = Ed;
+    g->Vb = Vb;
+    g->Eb = Eb;
+    g->shared = shared;
+    g->shared_size = shared_size;
+
+    long long o = 0;
     for (int i = 0; i < n; i++)
     {
-        g->Vd[i] = 0;
-        g->Va[i] = MIN_ALLOC;
-        g->V[i] = malloc(sizeof(int) * g->Va[i]);
+        g->V[i] = Vb + o;
+        g->Va[i] = Vd[i];
+        o += Vd[i];
     }
+    g->Vs = o;
+    g->Vc = o;
 
+    o = 0;
     for (int i = 0; i < m; i++)
     {
-        g->Ed[i] = 0;
-        g->Ea[i] = MIN_ALLOC;
-        g->E[i] = malloc(sizeof(int) * g->Ea[i]);
+        g->E[i] = Eb + o;
+        g->Ea[i] = Ed[i];
+        o += Ed[i];
     }
+    g->Es = o;
+    g->Ec = o;
 
     return g;
 }
 
-hypergraph *hypergraph_parse_dominating_set(FILE *f)
+void hypergraph_init_rows(hypergraph *g)
+{
+    long long sv = 0, se = 0;
+    for (int i = 0; i < g->n; i++)
+        sv += g->Vd[i];
+    for (int i = 0; i < g->m; i++)
+        se += g->Ed[i];
+
+    g->Vb = malloc(sizeof(int) * (sv > 0 ? sv : 1));
+    g->Eb = malloc(sizeof(int) * (se > 0 ? se : 1));
+
+    sv = 0;
+    for (int i = 0; i < g->n; i++)
+    {
+        g->V[i] = g->Vb + sv;
+        g->Va[i] = g->Vd[i];
+        sv += g->Vd[i];
+        g->Vd[i] = 0;
+    }
+
+    se = 0;
+    for (int i = 0; i < g->m; i++)
+    {
+        g->E[i] = g->Eb + se;
+        g->Ea[i] = g->Ed[i];
+        se += g->Ed[i];
+        g->Ed[i] = 0;
+    }
+
+    g->Vs = sv;
+    g->Vc = sv;
+    g->Es = se;
+    g->Ec = se;
+}
+
+// The first pass counts degrees, the second pass fills the exact-size rows
+hypergraph *hypergraph_parse_dominating_set(hypergraph_reader *r)
 {
     int n, m, u, v;
-    parse_unsigned_int(f, &n);
-    parse_unsigned_int(f, &m);
+    parse_unsigned_int(r, &n);
+    parse_unsigned_int(r, &m);
 
     hypergraph *g = hypergraph_init(n, n);
+    hypergraph_reader body = *r;
 
-    // Every vertex is part of their own hyperedge
-    for (int u = 0; u < n; u++)
+    for (int pass = 0; pass < 2; pass++)
+    {
+        *r = body;
+
+        // Every vertex is part of their own hyperedge
+        for (int u = 0; u < n; u++)
+        {
+            if (pass == 1)
+            {
+                g->V[u][g->Vd[u]] = u;
+                g->E[u][g->Ed[u]] = u;
+            }
+            g->Vd[u]++;
+            g->Ed[u]++;
+        }
+
+        for (int i = 0; i < m; i++)
+        {
+            skip_line(r);
+            skip_comments(r);
+
+            parse_unsigned_int(r, &u);
+            parse_unsigned_int(r, &v);
+
+            u--;
+            v--;
+
+            if (pass == 1)
+            {
+                g->V[u][g->Vd[u]] = v;
+                g->E[v][g->Ed[v]] = u;
+
+                g->V[v][g->Vd[v]] = u;
+                g->E[u][g->Ed[u]] = v;
+            }
+            g->Vd[u]++;
+            g->Ed[v]++;
+            g->Vd[v]++;
+            g->Ed[u]++;
+        }
+
+        if (pass == 0)
+            hypergraph_init_rows(g);
+    }
+
+    return g;
+}
+
+typedef struct
+{
+    int n_lines, n_kept;
+    int *S;         // Size of each edge line in the chunk
+    int *A;         // The (zero-indexed) vertices of all edge lines, concatenated
+    long long n_A;  // Total number of vertices in A
+    long long kept; // Number of vertices in A belonging to the first n_kept lines
+} hypergraph_chunk;
+
+static void hypergraph_parse_chunk(hypergraph_chunk *c, const char *p, const char *end)
+{
+    int a_S = 1024;
+    long long a_A = 1024;
+    c->S = malloc(sizeof(int) * a_S);
+    c->A = malloc(sizeof(int) * a_A);
+    c->n_lines = 0;
+    c->n_A = 0;
+
+    hypergraph_reader r = {.p = p, .end = end};
+    while (r.p < r.end)
     {
-        hypergraph_append_element(g->Vd + u, g->Va + u, g->V + u, u);
-        hypergraph_append_element(g->Ed + u, g->Ea + u, g->E + u, u);
+        if (*r.p == 'c')
+        {
+            skip_line(&r);
+            continue;
+        }
+
+        if (c->n_lines == a_S)
+        {
+            a_S *= 2;
+            c->S = realloc(c->S, sizeof(int) * a_S);
+        }
+
+        int d = 0, v;
+        parse_unsigned_int(&r, &v);
+        while (v > 0)
+        {
+            if (c->n_A == a_A)
+            {
+                a_A *= 2;
+                c->A = realloc(c->A, sizeof(int) * a_A);
+            }
+            c->A[c->n_A++] = v - 1;
+            d++;
+
+            parse_unsigned_int(&r, &v);
+        }
+        c->S[c->n_lines++] = d;
+        skip_line(&r);
     }
+}
 
-    for (int i = 0; i < m; i++)
+// Parse the edge lines in parallel, each thread handling a chunk that starts and ends at a line break
+hypergraph *hypergraph_parse_hitting_set_parallel(hypergraph_reader *r, int n, int m)
+{
+    skip_line(r);
+
+    int t = omp_get_max_threads();
+    size_t size = r->end - r->p;
+
+    const char **B = malloc(sizeof(char *) * (t + 1));
+    B[0] = r->p;
+    B[t] = r->end;
+    for (int i = 1; i < t; i++)
+    {
+        const char *p = r->p + (size * i) / t;
+        if (p < B[i - 1])
+            p = B[i - 1];
+        hypergraph_reader cr = {.p = p, .end = r->end};
+        if (p > r->p && p[-1] != '\n')
+            skip_line(&cr);
+        B[i] = cr.p;
+    }
+
+    hypergraph_chunk *C = malloc(sizeof(hypergraph_chunk) * t);
+
+#pragma omp parallel for schedule(static, 1)
+    for (int i = 0; i < t; i++)
+        hypergraph_parse_chunk(C + i, B[i], B[i + 1]);
+
+    // Prefix sums give each chunk its first edge and its offset in the edge block
+    hypergraph *g = hypergraph_init(n, m);
+
+    int *Ef = malloc(sizeof(int) * (t + 1));
+    long long *Af = malloc(sizeof(long long) * (t + 1));
+    Ef[0] = 0;
+    Af[0] = 0;
+    for (int i = 0; i < t; i++)
     {
-        skip_line(f);
-        skip_comments(f);
+        int kept = m - Ef[i];
+        if (kept > C[i].n_lines)
+            kept = C[i].n_lines;
+        C[i].n_kept = kept;
 
-        parse_unsigned_int(f, &u);
-        parse_unsigned_int(f, &v);
+        C[i].kept = 0;
+        for (int j = 0; j < kept; j++)
+            C[i].kept += C[i].S[j];
 
-        u--;
-        v--;
+        Ef[i + 1] = Ef[i] + kept;
+        Af[i + 1] = Af[i] + C[i].kept;
+    }
+
+    g->Eb = malloc(sizeof(int) * (Af[t] > 0 ? Af[t] : 1));
+    g->Es = Af[t];
+    g->Ec = Af[t];
+
+#pragma omp parallel for schedule(static, 1)
+    for (int i = 0; i < t; i++)
+    {
+        memcpy(g->Eb + Af[i], C[i].A, sizeof(int) * C[i].kept);
 
-        hypergraph_append_element(g->Vd + u, g->Va + u, g->V + u, v);
-        hypergraph_append_element(g->Ed + v, g->Ea + v, g->E + v, u);
+        long long o = Af[i];
+        for (int j = 0; j < C[i].n_kept; j++)
+        {
+            int e = Ef[i] + j;
+            g->E[e] = g->Eb + o;
+            g->Ed[e] = C[i].S[j];
+            g->Ea[e] = C[i].S[j];
+            o += C[i].S[j];
+        }
+
+        for (long long j = 0; j < C[i].kept; j++)
+        {
+#pragma omp atomic
+            g->Vd[C[i].A[j]]++;
+        }
+
+        free(C[i].S);
+        free(C[i].A);
+    }
+
+    // Edges declared in the header but missing from the input stay empty
+    for (int e = Ef[t]; e < m; e++)
+    {
+        g->E[e] = g->Eb + Af[t];
+        g->Ed[e] = 0;
+        g->Ea[e] = 0;
+    }
+
+    long long sv = 0;
+    g->Vb = malloc(sizeof(int) * (Af[t] > 0 ? Af[t] : 1));
+    g->Vs = Af[t];
+    g->Vc = Af[t];
+    for (int u = 0; u < n; u++)
+    {
+        g->V[u] = g->Vb + sv;
+        g->Va[u] = g->Vd[u];
+        sv += g->Vd[u];
+        g->Vd[u] = 0;
+    }
 
-        hypergraph_append_element(g->Vd + v, g->Va + v, g->V + v, u);
-        hypergraph_append_element(g->Ed + u, g->Ea + u, g->E + u, v);
+    // Transpose, the vertex rows are left unsorted until hypergraph_sort
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int e = 0; e < m; e++)
+    {
+        for (int j = 0; j < g->Ed[e]; j++)
+        {
+            int v = g->E[e][j];
+            int p;
+#pragma omp atomic capture
+            p = g->Vd[v]++;
+            g->V[v][p] = e;
+        }
     }
 
+    free(B);
+    free(C);
+    free(Ef);
+    free(Af);
+
     return g;
 }
 
-hypergraph *hypergraph_parse_hitting_set(FILE *f)
+hypergraph *hypergraph_parse_hitting_set(hypergraph_reader *r)
 {
     int n, m, v;
-    parse_unsigned_int(f, &n);
-    parse_unsigned_int(f, &m);
+    parse_unsigned_int(r, &n);
+    parse_unsigned_int(r, &m);
+
+    if (r->end - r->p >= PARALLEL_PARSE_MIN_SIZE && omp_get_max_threads() > 1)
+        return hypergraph_parse_hitting_set_parallel(r, n, m);
 
     hypergraph *g = hypergraph_init(n, m);
+    hypergraph_reader body = *r;
 
-    for (int i = 0; i < m; i++)
+    for (int pass = 0; pass < 2; pass++)
     {
-        skip_line(f);
-        skip_comments(f);
+        *r = body;
 
-        parse_unsigned_int(f, &v);
-        while (v > 0)
+        for (int i = 0; i < m; i++)
         {
-            v--;
-            hypergraph_append_element(g->Vd + v, g->Va + v, g->V + v, i);
-            hypergraph_append_element(g->Ed + i, g->Ea + i, g->E + i, v);
-
-            parse_unsigned_int(f, &v);
+            skip_line(r);
+            skip_comments(r);
+
+            parse_unsigned_int(r, &v);
+            while (v > 0)
+            {
+                v--;
+                if (pass == 1)
+                {
+                    g->V[v][g->Vd[v]] = i;
+                    g->E[i][g->Ed[i]] = v;
+                }
+                g->Vd[v]++;
+                g->Ed[i]++;
+
+                parse_unsigned_int(r, &v);
+            }
         }
+
+        if (pass == 0)
+            hypergraph_init_rows(g);
     }
 
     return g;
 }
 
-hypergraph *hypergraph_parse(FILE *f)
+/*
+    Binary snapshot layout (native byte order):
+        hypergraph_snapshot_header
+        Vd[n], Ed[m]
+        the vertex rows, concatenated (nv integers)
+        the edge rows, concatenated (ne integers)
+        the reduction log (nl entries, from version 2)
+*/
+typedef struct
+{
+    char magic[8];
+    int version;
+    int n, m;
+    int nl;
+    long long nv, ne;
+} hypergraph_snapshot_header;
+
+static const char hypergraph_snapshot_magic[8] = "HGSNAP\0";
+
+static inline int is_snapshot(const char *data, size_t size)
+{
+    return size >= sizeof(hypergraph_snapshot_header) &&
+           memcmp(data, hypergraph_snapshot_magic, sizeof(hypergraph_snapshot_magic)) == 0;
+}
+
+// If map is not NULL, the graph is built directly on top of it and takes ownership of the mapping
+static hypergraph *hypergraph_parse_snapshot(char *data, size_t size, void *map, size_t map_size)
+{
+    hypergraph_snapshot_header h;
+    memcpy(&h, data, sizeof(h));
+
+    // Version 1 had no log, and the field was always 0
+    if (h.version == 1)
+        h.nl = 0;
+    if (h.version < 1 || h.version > HYPERGRAPH_SNAPSHOT_VERSION || h.n < 0 || h.m < 0 || h.nv < 0 || h.ne < 0 || h.nl < 0)
+        return NULL;
+
+    // Each count is checked against the file on its own first, so the total below cannot overflow
+    size_t body = size - sizeof(h);
+    if ((size_t)h.n > body || (size_t)h.m > body || (size_t)h.nv > body || (size_t)h.ne > body || (size_t)h.nl > body ||
+        sizeof(int) * ((size_t)h.n + (size_t)h.m + (size_t)h.nv + (size_t)h.ne) + sizeof(hypergraph_log_entry) * (size_t)h.nl > body)
+        return NULL;
+
+    int *Vd = (int *)(data + sizeof(h));
+    int *Ed = Vd + h.n;
+    int *Vb = Ed + h.m;
+    int *Eb = Vb + h.nv;
+
+    // The rows must fill the arenas exactly and only name vertices and edges that exist
+    long long sv = 0, se = 0;
+    for (int i = 0; i < h.n; i++)
+        sv += Vd[i] < 0 ? h.nv + 1 : Vd[i];
+    for (int i = 0; i < h.m; i++)
+        se += Ed[i] < 0 ? h.ne + 1 : Ed[i];
+    if (sv != h.nv || se != h.ne)
+        return NULL;
+    for (long long i = 0; i < h.nv; i++)
+        if (Vb[i] < 0 || Vb[i] >= h.m)
+            return NULL;
+    for (long long i = 0; i < h.ne; i++)
+        if (Eb[i] < 0 || Eb[i] >= h.n)
+            return NULL;
+
+    // Lifting a solution indexes it with the vertices in the log
+    const hypergraph_log_entry *L = (const hypergraph_log_entry *)(Eb + h.ne);
+    for (int i = 0; i < h.nl; i++)
+        if (L[i].type < 0 || L[i].type >= HYPERGRAPH_LOG_TYPES || L[i].u < 0 || L[i].u >= h.n || L[i].v < 0 || L[i].v >= h.n ||
+            L[i].w < 0 || L[i].w >= h.n)
+            return NULL;
+
+    hypergraph *g = hypergraph_init_shell(h.n, h.m);
+
+    if (map != NULL)
+    {
+        g->Vd = Vd;
+        g->Ed = Ed;
+        g->Vb = Vb;
+        g->Eb = Eb;
+    }
+    else
+    {
+        g->Vd = malloc(sizeof(int) * g->n);
+        g->Ed = malloc(sizeof(int) * g->m);
+        g->Vb = malloc(sizeof(int) * (h.nv > 0 ? h.nv : 1));
+        g->Eb = malloc(sizeof(int) * (h.ne > 0 ? h.ne : 1));
+
+        memcpy(g->Vd, Vd, sizeof(int) * g->n);
+        memcpy(g->Ed, Ed, sizeof(int) * g->m);
+        memcpy(g->Vb, Vb, sizeof(int) * h.nv);
+        memcpy(g->Eb, Eb, sizeof(int) * h.ne);
+    }
+    g->Vs = h.nv;
+    g->Vc = h.nv;
+    g->Es = h.ne;
+    g->Ec = h.ne;
+    g->map = map;
+    g->map_size = map_size;
+
+    if (h.nl > 0)
+    {
+        g->log = malloc(sizeof(hypergraph_log_entry) * h.nl);
+        memcpy(g->log, L, sizeof(hypergraph_log_entry) * h.nl);
+        g->log_size = h.nl;
+        g->log_cap = h.nl;
+    }
+
+    long long o = 0;
+    for (int i = 0; i < g->n; i++)
+    {
+        g->V[i] = g->Vb + o;
+        g->Va[i] = g->Vd[i];
+        o += g->Vd[i];
+    }
+    o = 0;
+    for (int i = 0; i < g->m; i++)
+    {
+        g->E[i] = g->Eb + o;
+        g->Ea[i] = g->Ed[i];
+        o += g->Ed[i];
+    }
+
+    return g;
+}
+
+int hypergraph_write_snapshot(hypergraph *g, const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+        return 0;
+
+    hypergraph_snapshot_header h = {.version = HYPERGRAPH_SNAPSHOT_VERSION, .n = g->n, .m = g->m, .nl = (int)g->log_size};
+    memcpy(h.magic, hypergraph_snapshot_magic, sizeof(h.magic));
+    h.nv = 0;
+    h.ne = 0;
+    for (int i = 0; i < g->n; i++)
+        h.nv += g->Vd[i];
+    for (int i = 0; i < g->m; i++)
+        h.ne += g->Ed[i];
+
+    int ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    ok = ok && fwrite(g->Vd, sizeof(int), g->n, f) == (size_t)g->n;
+    ok = ok && fwrite(g->Ed, sizeof(int), g->m, f) == (size_t)g->m;
+    for (int i = 0; i < g->n && ok; i++)
+        ok = fwrite(g->V[i], sizeof(int), g->Vd[i], f) == (size_t)g->Vd[i];
+    for (int i = 0; i < g->m && ok; i++)
+        ok = fwrite(g->E[i], sizeof(int), g->Ed[i], f) == (size_t)g->Ed[i];
+    if (g->log_size > 0)
+        ok = ok && fwrite(g->log, sizeof(hypergraph_log_entry), g->log_size, f) == (size_t)g->log_size;
+
+    ok = fclose(f) == 0 && ok;
+    return ok;
+}
+
+hypergraph *hypergraph_load_snapshot(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+        return NULL;
+
+    hypergraph *g = hypergraph_parse(f);
+    fclose(f);
+    return g;
+}
+
+hypergraph *hypergraph_parse_buffer(const char *data, size_t size)
 {
     hypergraph *g = NULL;
+    hypergraph_reader r = {.p = data, .end = data + size};
+
+    if (is_snapshot(data, size))
+        return hypergraph_parse_snapshot((char *)data, size, NULL, 0);
 
-    skip_comments(f);
+    skip_comments(&r);
+    if (r.end - r.p < 3)
+        return NULL;
 
-    int c = fgetc_unlocked(f);
-    c = fgetc_unlocked(f);
-    c = fgetc_unlocked(f);
+    char c = r.p[2];
+    r.p += 3;
 
     // Dominating Set instance
     if (c == 'd')
     {
-        g = hypergraph_parse_dominating_set(f);
+        g = hypergraph_parse_dominating_set(&r);
     }
     // Hitting Set instance
     else if (c == 'h')
     {
-        g = hypergraph_parse_hitting_set(f);
+        g = hypergraph_parse_hitting_set(&r);
     }
 
     return g;
 }
 
-hypergraph *hypergraph_copy(hypergraph *g)
+hypergraph_input *hypergraph_input_read(FILE *f)
+{
+    hypergraph_input *in = malloc(sizeof(hypergraph_input));
+    struct stat st;
+    int fd = fileno(f);
+
+    // Regular files are mapped directly, anything else (pipes) is read into one buffer
+    if (fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && ftello(f) == 0)
+    {
+        char *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            *in = (hypergraph_input){.data = data, .size = st.st_size, .mapped = 1};
+            return in;
+        }
+    }
+
+    size_t size = 0, cap = 1 << 20;
+    char *data = malloc(cap);
+    size_t r;
+    while ((r = fread(data + size, 1, cap - size, f)) > 0)
+    {
+        size += r;
+        if (size == cap)
+        {
+            cap *= 2;
+            data = realloc(data, cap);
+        }
+    }
+
+    *in = (hypergraph_input){.data = data, .size = size, .mapped = 0};
+    return in;
+}
+
+void hypergraph_input_free(hypergraph_input *in)
 {
-    hypergraph *c = malloc(sizeof(hypergraph));
+    if (in->mapped && in->data != NULL)
+        munmap(in->data, in->size);
+    else
+        free(in->data);
+    free(in);
+}
 
-    *c = (hypergraph){.n = g->n, .m = g->m};
+static inline unsigned long long hash_mix(unsigned long long h, unsigned long long w)
+{
+    h ^= w * 0x87C37B91114253D5ull;
+    h = (h << 31) | (h >> 33);
+    return h * 0x4CF5AD432745937Full;
+}
 
-    c->Vd = malloc(sizeof(int *) * c->n);
-    c->Va = malloc(sizeof(int *) * c->n);
-    c->V = malloc(sizeof(int *) * c->n);
+unsigned long long hypergraph_input_hash(hypergraph_input *in)
+{
+    const char *p = in->data;
+    size_t n = in->size;
 
-    for (int i = 0; i < c->n; i++)
+    // Four independent lanes over 32 byte blocks, then the tail one byte at a time
+    unsigned long long h[4] = {0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull, 0x27D4EB2F165667C5ull};
+    while (n >= 32)
     {
-        c->Vd[i] = g->Vd[i];
-        c->Va[i] = g->Va[i];
-        c->V[i] = malloc(sizeof(int) * c->Va[i]);
+        unsigned long long w[4];
+        memcpy(w, p, sizeof(w));
+        for (int i = 0; i < 4; i++)
+            h[i] = hash_mix(h[i], w[i]);
+        p += 32;
+        n -= 32;
+    }
 
-        for (int j = 0; j < c->Vd[i]; j++)
-            c->V[i][j] = g->V[i][j];
+    unsigned long long r = in->size;
+    for (int i = 0; i < 4; i++)
+        r = hash_mix(r, h[i]);
+    while (n > 0)
+    {
+        r = hash_mix(r, (unsigned char)*p++);
+        n--;
     }
 
-    c->Ed = malloc(sizeof(int *) * c->m);
-    c->Ea = malloc(sizeof(int *) * c->m);
-    c->E = malloc(sizeof(int *) * c->m);
+    r ^= r >> 33;
+    r *= 0xFF51AFD7ED558CCDull;
+    r ^= r >> 33;
+    return r;
+}
+
+hypergraph *hypergraph_parse_input(hypergraph_input *in)
+{
+    if (!in->mapped)
+        return hypergraph_parse_buffer(in->data, in->size);
+
+    // Snapshots are used in place, writes go to private copies of the touched pages
+    if (is_snapshot(in->data, in->size) && mprotect(in->data, in->size, PROT_READ | PROT_WRITE) == 0)
+    {
+        hypergraph *g = hypergraph_parse_snapshot(in->data, in->size, in->data, in->size);
+        if (g != NULL)
+            in->data = NULL;
+        return g;
+    }
+
+    madvise(in->data, in->size, MADV_SEQUENTIAL);
+    return hypergraph_parse_buffer(in->data, in->size);
+}
+
+hypergraph *hypergraph_parse(FILE *f)
+{
+    hypergraph_input *in = hypergraph_input_read(f);
+    hypergraph *g = hypergraph_parse_input(in);
+    hypergraph_input_free(in);
+    return g;
+}
+
+hypergraph *hypergraph_copy(hypergraph *g)
+{
+    hypergraph_compact(g);
+
+    hypergraph *c = hypergraph_init(g->n, g->m);
+
+    memcpy(c->Vd, g->Vd, sizeof(int) * g->n);
+    memcpy(c->Va, g->Va, sizeof(int) * g->n);
+    memcpy(c->Ed, g->Ed, sizeof(int) * g->m);
+    memcpy(c->Ea, g->Ea, sizeof(int) * g->m);
+
+    // Only the used part of the arenas is copied, the rows keep their offsets
+    c->Vb = malloc(sizeof(int) * (g->Vs > 0 ? g->Vs : 1));
+    c->Eb = malloc(sizeof(int) * (g->Es > 0 ? g->Es : 1));
+    if (g->Vs > 0)
+        memcpy(c->Vb, g->Vb, sizeof(int) * g->Vs);
+    if (g->Es > 0)
+        memcpy(c->Eb, g->Eb, sizeof(int) * g->Es);
+    c->Vs = g->Vs;
+    c->Vc = g->Vs;
+    c->Es = g->Es;
+    c->Ec = g->Es;
+
+    for (int i = 0; i < c->n; i++)
+        c->V[i] = c->Vb + (g->V[i] - g->Vb);
 
     for (int i = 0; i < c->m; i++)
+        c->E[i] = c->Eb + (g->E[i] - g->Eb);
+
+    if (g->Vsig != NULL)
     {
-        c->Ed[i] = g->Ed[i];
-        c->Ea[i] = g->Ea[i];
-        c->E[i] = malloc(sizeof(int) * c->Ea[i]);
+        c->Vsig = malloc(sizeof(unsigned long long) * g->n);
+        c->Esig = malloc(sizeof(unsigned long long) * g->m);
+        memcpy(c->Vsig, g->Vsig, sizeof(unsigned long long) * g->n);
+        memcpy(c->Esig, g->Esig, sizeof(unsigned long long) * g->m);
+    }
 
-        for (int j = 0; j < c->Ed[i]; j++)
-            c->E[i][j] = g->E[i][j];
+    if (g->Vo != NULL)
+    {
+        c->Vo = malloc(sizeof(int) * g->n);
+        c->Vod = malloc(sizeof(int) * g->n);
+        c->Eo = malloc(sizeof(int) * g->m);
+        c->Eod = malloc(sizeof(int) * g->m);
+        memcpy(c->Vo, g->Vo, sizeof(int) * g->n);
+        memcpy(c->Vod, g->Vod, sizeof(int) * g->n);
+        memcpy(c->Eo, g->Eo, sizeof(int) * g->m);
+        memcpy(c->Eod, g->Eod, sizeof(int) * g->m);
+        c->Vr = malloc(sizeof(int) * g->n);
+        c->Er = malloc(sizeof(int) * g->m);
+        memcpy(c->Vr, g->Vr, sizeof(int) * g->n);
+        memcpy(c->Er, g->Er, sizeof(int) * g->m);
+    }
+
+    if (g->log_size > 0)
+    {
+        c->log = malloc(sizeof(hypergraph_log_entry) * g->log_size);
+        memcpy(c->log, g->log, sizeof(hypergraph_log_entry) * g->log_size);
+        c->log_size = g->log_size;
+        c->log_cap = g->log_size;
     }
 
     return c;
 }
 
+static inline int is_sorted(const int *A, int n)
+{
+    for (int i = 1; i < n; i++)
+        if (A[i] <= A[i - 1])
+            return 0;
+    return 1;
+}
+
+static inline void insertion_sort(int *A, int n)
+{
+    for (int i = 1; i < n; i++)
+    {
+        int x = A[i];
+        int j = i;
+        while (j > 0 && A[j - 1] > x)
+        {
+            A[j] = A[j - 1];
+            j--;
+        }
+        A[j] = x;
+    }
+}
+
+// LSD radix sort on bytes, T is scratch space of size n. Only the bytes used by the largest value
+// are sorted on, and passes where every element has the same byte are skipped
+static void radix_sort(int *A, int n, int *T)
+{
+    unsigned int mask = 0;
+    for (int i = 0; i < n; i++)
+        mask |= (unsigned int)A[i];
+
+    int *src = A, *dst = T;
+    for (int shift = 0; shift < 32 && (mask >> shift) > 0; shift += 8)
+    {
+        int C[256] = {0};
+        for (int i = 0; i < n; i++)
+            C[((unsigned int)src[i] >> shift) & 255]++;
+
+        if (C[((unsigned int)src[0] >> shift) & 255] == n)
+            continue;
+
+        int o = 0;
+        for (int b = 0; b < 256; b++)
+        {
+            int c = C[b];
+            C[b] = o;
+            o += c;
+        }
+
+        for (int i = 0; i < n; i++)
+            dst[C[((unsigned int)src[i] >> shift) & 255]++] = src[i];
+
+        int *t = src;
+        src = dst;
+        dst = t;
+    }
+
+    if (src != A)
+        memcpy(A, src, sizeof(int) * n);
+}
+
+static inline int sort_row(int *A, int n, int *T)
+{
+    // Rows that are already sorted (e.g. loaded from a snapshot) are left untouched
+    if (is_sorted(A, n))
+        return n;
+
+    if (n <= SORT_INSERTION_MAX)
+        insertion_sort(A, n);
+    else
+        radix_sort(A, n, T);
+
+    int d = 0;
+    for (int j = 0; j < n; j++)
+    {
+        if (j == 0 || A[j] > A[d - 1])
+            A[d++] = A[j];
+    }
+    return d;
+}
+
 void hypergraph_sort(hypergraph *g)
 {
+    int md = 0;
+#pragma omp parallel for reduction(max : md)
     for (int i = 0; i < g->n; i++)
-        qsort(g->V[i], g->Vd[i], sizeof(int), hypergraph_compare);
-
+        md = g->Vd[i] > md ? g->Vd[i] : md;
+#pragma omp parallel for reduction(max : md)
     for (int i = 0; i < g->m; i++)
-        qsort(g->E[i], g->Ed[i], sizeof(int), hypergraph_compare);
+        md = g->Ed[i] > md ? g->Ed[i] : md;
+
+#pragma omp parallel
+    {
+        int *T = md > SORT_INSERTION_MAX ? malloc(sizeof(int) * md) : NULL;
+
+#pragma omp for schedule(dynamic, 1024) nowait
+        for (int i = 0; i < g->n; i++)
+            g->Vd[i] = sort_row(g->V[i], g->Vd[i], T);
+
+#pragma omp for schedule(dynamic, 1024)
+        for (int i = 0; i < g->m; i++)
+            g->Ed[i] = sort_row(g->E[i], g->Ed[i], T);
+
+        free(T);
+    }
+}
+
+// Test if p is inside memory that g does not own, either the snapshot mapping or a shared buffer
+static inline int borrowed(hypergraph *g, const void *p)
+{
+    if (g->map != NULL && (const char *)p >= (const char *)g->map &&
+        (const char *)p < (const char *)g->map + g->map_size)
+        return 1;
+    return g->shared != NULL && (const int *)p >= g->shared && (const int *)p < g->shared + g->shared_size;
+}
+
+void hypergraph_free_rows(hypergraph *g)
+{
+    if (!borrowed(g, g->Vb))
+        free(g->Vb);
+    if (!borrowed(g, g->Eb))
+        free(g->Eb);
+    g->Vb = NULL;
+    g->Eb = NULL;
+    g->Vs = 0;
+    g->Es = 0;
+    g->Vc = 0;
+    g->Ec = 0;
 
     for (int i = 0; i < g->n; i++)
     {
-        int d = 0;
-        for (int j = 0; j < g->Vd[i]; j++)
-        {
-            if (j == 0 || g->V[i][j] > g->V[i][d - 1])
-                g->V[i][d++] = g->V[i][j];
-        }
-        g->Vd[i] = d;
+        g->Vd[i] = 0;
+        g->Va[i] = 0;
+        g->V[i] = NULL;
     }
     for (int i = 0; i < g->m; i++)
     {
-        int d = 0;
-        for (int j = 0; j < g->Ed[i]; j++)
-        {
-            if (j == 0 || g->E[i][j] > g->E[i][d - 1])
-                g->E[i][d++] = g->E[i][j];
-        }
-        g->Ed[i] = d;
+        g->Ed[i] = 0;
+        g->Ea[i] = 0;
+        g->E[i] = NULL;
     }
+    hypergraph_free_degree_order(g);
 }
 
 void hypergraph_free(hypergraph *g)
 {
-    free(g->Vd);
+    if (!borrowed(g, g->Vd))
+        free(g->Vd);
+    if (!borrowed(g, g->Ed))
+        free(g->Ed);
+    if (!borrowed(g, g->Vb))
+        free(g->Vb);
+    if (!borrowed(g, g->Eb))
+        free(g->Eb);
+    if (g->map != NULL)
+        munmap(g->map, g->map_size);
+
     free(g->Va);
-    for (int i = 0; i < g->n; i++)
-        free(g->V[i]);
     free(g->V);
-
-    free(g->Ed);
     free(g->Ea);
-    for (int i = 0; i < g->m; i++)
-        free(g->E[i]);
     free(g->E);
+    free(g->Vl);
+    free(g->El);
+    free(g->Vsig);
+    free(g->Esig);
+    hypergraph_free_degree_order(g);
+    free(g->log);
 
     free(g);
 }
@@ -313,11 +1087,144 @@ int hypergraph_validate(hypergraph *g)
         }
     }
 
+    if (g->Vsig != NULL && g->lazy == 0)
+    {
+        for (int i = 0; i < g->n; i++)
+            if (g->Vsig[i] != row_signature(g->V[i], g->Vd[i]))
+                return 0;
+        for (int i = 0; i < g->m; i++)
+            if (g->Esig[i] != row_signature(g->E[i], g->Ed[i]))
+                return 0;
+    }
+
     return 1;
 }
 
+// Lazy deletion, removed entries stay in their row as tombstones ~id until the row is compacted
+
+static inline int decode(int x)
+{
+    return x < 0 ? ~x : x;
+}
+
+// Same as lower_bound, but the row may contain tombstones
+static inline int lower_bound_lazy(const int *A, int n, int x)
+{
+    const int *s = A;
+    while (n > 1)
+    {
+        int h = n / 2;
+        s += (decode(s[h - 1]) < x) * h;
+        n -= h;
+    }
+    s += (n == 1 && decode(s[0]) < x);
+    return s - A;
+}
+
+static inline int compact_row(int *A, int n)
+{
+    int d = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (A[i] >= 0)
+            A[d++] = A[i];
+    }
+    return d;
+}
+
+void hypergraph_lazy_begin(hypergraph *g)
+{
+    if (g->lazy++ > 0)
+        return;
+
+    g->Vl = malloc(sizeof(int) * g->n);
+    g->El = malloc(sizeof(int) * g->m);
+    memcpy(g->Vl, g->Vd, sizeof(int) * g->n);
+    memcpy(g->El, g->Ed, sizeof(int) * g->m);
+    g->dead = 0;
+}
+
+void hypergraph_lazy_end(hypergraph *g)
+{
+    if (g->lazy > 1)
+    {
+        g->lazy--;
+        return;
+    }
+
+    hypergraph_compact(g);
+    g->lazy = 0;
+
+    free(g->Vl);
+    free(g->El);
+    g->Vl = NULL;
+    g->El = NULL;
+}
+
+void hypergraph_compact_vertex(hypergraph *g, int u)
+{
+    g->dead -= g->Vl[u] - g->Vd[u];
+    g->Vl[u] = compact_row(g->V[u], g->Vl[u]);
+    assert(g->Vl[u] == g->Vd[u]);
+    hypergraph_update_vertex_signature(g, u);
+}
+
+void hypergraph_compact_edge(hypergraph *g, int e)
+{
+    g->dead -= g->El[e] - g->Ed[e];
+    g->El[e] = compact_row(g->E[e], g->El[e]);
+    assert(g->El[e] == g->Ed[e]);
+    hypergraph_update_edge_signature(g, e);
+}
+
+void hypergraph_compact(hypergraph *g)
+{
+    if (g->lazy == 0)
+        return;
+
+    for (int u = 0; u < g->n; u++)
+        hypergraph_clean_vertex(g, u);
+    for (int e = 0; e < g->m; e++)
+        hypergraph_clean_edge(g, e);
+
+    if (g->Vo != NULL)
+        hypergraph_build_degree_order(g);
+}
+
+void hypergraph_compact_if_needed(hypergraph *g)
+{
+    if (g->lazy > 0 && g->dead > ((long long)g->n + g->m) / 4)
+        hypergraph_compact(g);
+}
+
 void hypergraph_remove_vertex(hypergraph *g, int u)
 {
+    g->removed_v += g->Vd[u] > 0;
+    g->may_split += g->Vd[u] > 1;
+
+    if (g->lazy > 0)
+    {
+        for (int i = 0; i < g->Vl[u]; i++)
+        {
+            int e = g->V[u][i];
+            if (e < 0)
+                continue;
+
+            int p = lower_bound_lazy(g->E[e], g->El[e], u);
+            assert(p < g->El[e] && g->E[e][p] == u);
+            g->E[e][p] = ~u;
+            g->Ed[e]--;
+            g->dead++;
+        }
+
+        g->dead -= g->Vl[u] - g->Vd[u];
+        g->Vd[u] = 0;
+        g->Vl[u] = 0;
+        if (g->Vsig != NULL)
+            g->Vsig[u] = 0;
+        return;
+    }
+
     for (int i = 0; i < g->Vd[u]; i++)
     {
         int e = g->V[u][i];
@@ -326,25 +1233,56 @@ void hypergraph_remove_vertex(hypergraph *g, int u)
         assert(p < g->Ed[e] && g->E[e][p] == u);
         memmove(g->E[e] + p, g->E[e] + p + 1, sizeof(int) * (g->Ed[e] - p - 1));
         g->Ed[e]--;
+        hypergraph_update_edge_signature(g, e);
     }
 
     g->Vd[u] = 0;
+    if (g->Vsig != NULL)
+        g->Vsig[u] = 0;
 }
 
 void hypergraph_remove_edge(hypergraph *g, int e)
 {
-    for (int i = 0; i < g->Ed[e]; i++)
-    {
-        int v = g->E[e][i];
+    g->removed_e += g->Ed[e] > 0;
 
-        int p = lower_bound(g->V[v], g->Vd[v], e);
-        assert(p < g->Vd[v] && g->V[v][p] == e);
-        memmove(g->V[v] + p, g->V[v] + p + 1, sizeof(int) * (g->Vd[v] - p - 1));
-        g->Vd[v]--;
+    // Vertices that still have edges after the removal
+    int attached = 0;
+    if (g->lazy > 0)
+    {
+        for (int i = 0; i < g->El[e]; i++)
+        {
+            int v = g->E[e][i];
+            if (v < 0)
+                continue;
+
+            int p = lower_bound_lazy(g->V[v], g->Vl[v], e);
+            assert(p < g->Vl[v] && g->V[v][p] == e);
+            g->V[v][p] = ~e;
+            g->Vd[v]--;
+            g->dead++;
+            attached += g->Vd[v] > 0;
+        }
+        g->dead -= g->El[e] - g->Ed[e];
+        g->El[e] = 0;
     }
+    else
+    {
+        for (int i = 0; i < g->Ed[e]; i++)
+        {
+            int v = g->E[e][i];
+
+            int p = lower_bound(g->V[v], g->Vd[v], e);
+            assert(p < g->Vd[v] && g->V[v][p] == e);
+            memmove(g->V[v] + p, g->V[v] + p + 1, sizeof(int) * (g->Vd[v] - p - 1));
+            g->Vd[v]--;
+            hypergraph_update_vertex_signature(g, v);
+            attached += g->Vd[v] > 0;
+        }
+    }
+    g->may_split += attached > 1;
     g->Ed[e] = 0;
-    g->Ea[e] = MIN_ALLOC;
-    g->E[e] = realloc(g->E[e], sizeof(int) * g->Ea[e]);
+    if (g->Esig != NULL)
+        g->Esig[e] = 0;
 }
 
 void hypergraph_include_vertex(hypergraph *g, int u)
@@ -352,14 +1290,287 @@ void hypergraph_include_vertex(hypergraph *g, int u)
     if (g->Vd[u] == 0)
         return;
 
+    // The edge {u} that is kept is a component of its own
+    g->may_split++;
+
+    hypergraph_clean_vertex(g, u);
+
     int e = g->V[u][0];
-    while (g->Vd[u] > 0)
-        hypergraph_remove_edge(g, g->V[u][0]);
+    if (g->lazy > 0)
+    {
+        // Removing an edge only leaves a tombstone in V[u], so a single pass is enough
+        for (int i = 0; i < g->Vl[u]; i++)
+        {
+            if (g->V[u][i] >= 0)
+                hypergraph_remove_edge(g, g->V[u][i]);
+        }
+        g->dead -= g->Vl[u];
+        g->Vl[u] = 1;
+        g->El[e] = 1;
+    }
+    else
+    {
+        while (g->Vd[u] > 0)
+            hypergraph_remove_edge(g, g->V[u][0]);
+    }
 
+    // e is kept as the edge {u}
+    g->removed_e--;
     g->Ed[e] = 1;
     g->E[e][0] = u;
     g->Vd[u] = 1;
     g->V[u][0] = e;
-    g->Va[u] = MIN_ALLOC;
-    g->V[u] = realloc(g->V[u], sizeof(int) * g->Va[u]);
-}
\ No newline at end of file
+    if (g->Vsig != NULL)
+    {
+        g->Vsig[u] = hypergraph_signature_bit(e);
+        g->Esig[e] = hypergraph_signature_bit(u);
+    }
+}
+
+// Take k entries from the end of an arena. When it is full, the arena is moved to a block of twice
+// the size and the r rows in R are rebased. Arenas inside a snapshot mapping or a shared buffer are left in place
+static int *arena_alloc(hypergraph *g, int **B, long long *s, long long *c, int **R, int r, long long k)
+{
+    if (*s + k > *c)
+    {
+        long long nc = *c * 2;
+        if (nc < *s + k)
+            nc = *s + k;
+        if (nc < MIN_ALLOC)
+            nc = MIN_ALLOC;
+
+        int *nb = malloc(sizeof(int) * nc);
+        if (*B != NULL)
+        {
+            memcpy(nb, *B, sizeof(int) * *s);
+            for (int i = 0; i < r; i++)
+                R[i] = nb + (R[i] - *B);
+            if (!borrowed(g, *B))
+                free(*B);
+        }
+        *B = nb;
+        *c = nc;
+    }
+
+    int *p = *B + *s;
+    *s += k;
+    return p;
+}
+
+void hypergraph_reserve_vertex(hypergraph *g, int u, int c)
+{
+    if (g->Va[u] >= c)
+        return;
+
+    hypergraph_clean_vertex(g, u);
+    if (c < g->Va[u] * 2)
+        c = g->Va[u] * 2;
+    if (c < MIN_ALLOC)
+        c = MIN_ALLOC;
+
+    // The last row in the arena can grow in place
+    if (g->V[u] + g->Va[u] == g->Vb + g->Vs && g->Vs - g->Va[u] + c <= g->Vc)
+    {
+        g->Vs += c - g->Va[u];
+        g->Va[u] = c;
+        return;
+    }
+
+    int *p = arena_alloc(g, &g->Vb, &g->Vs, &g->Vc, g->V, g->n, c);
+    memcpy(p, g->V[u], sizeof(int) * g->Vd[u]);
+    g->V[u] = p;
+    g->Va[u] = c;
+}
+
+void hypergraph_reserve_edge(hypergraph *g, int e, int c)
+{
+    if (g->Ea[e] >= c)
+        return;
+
+    hypergraph_clean_edge(g, e);
+    if (c < g->Ea[e] * 2)
+        c = g->Ea[e] * 2;
+    if (c < MIN_ALLOC)
+        c = MIN_ALLOC;
+
+    if (g->E[e] + g->Ea[e] == g->Eb + g->Es && g->Es - g->Ea[e] + c <= g->Ec)
+    {
+        g->Es += c - g->Ea[e];
+        g->Ea[e] = c;
+        return;
+    }
+
+    int *p = arena_alloc(g, &g->Eb, &g->Es, &g->Ec, g->E, g->m, c);
+    memcpy(p, g->E[e], sizeof(int) * g->Ed[e]);
+    g->E[e] = p;
+    g->Ea[e] = c;
+}
+
+void hypergraph_build_signatures(hypergraph *g)
+{
+    if (g->Vsig == NULL)
+        g->Vsig = malloc(sizeof(unsigned long long) * g->n);
+    if (g->Esig == NULL)
+        g->Esig = malloc(sizeof(unsigned long long) * g->m);
+
+    hypergraph_compact(g);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int u = 0; u < g->n; u++)
+        g->Vsig[u] = row_signature(g->V[u], g->Vd[u]);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int e = 0; e < g->m; e++)
+        g->Esig[e] = row_signature(g->E[e], g->Ed[e]);
+}
+
+void hypergraph_update_vertex_signature(hypergraph *g, int u)
+{
+    if (g->Vsig != NULL)
+        g->Vsig[u] = row_signature(g->V[u], g->Vd[u]);
+}
+
+void hypergraph_update_edge_signature(hypergraph *g, int e)
+{
+    if (g->Esig != NULL)
+        g->Esig[e] = row_signature(g->E[e], g->Ed[e]);
+}
+
+// Counting sort of the n rows with degrees D by decreasing degree
+static void degree_order(const int *D, int n, int *O, int *OD, int *R)
+{
+    int md = 0;
+    for (int i = 0; i < n; i++)
+        if (D[i] > md)
+            md = D[i];
+
+    int *C = calloc(md + 2, sizeof(int));
+    for (int i = 0; i < n; i++)
+        C[md - D[i] + 1]++;
+    for (int d = 1; d <= md + 1; d++)
+        C[d] += C[d - 1];
+
+    for (int i = 0; i < n; i++)
+    {
+        int p = C[md - D[i]]++;
+        O[p] = i;
+        OD[p] = D[i];
+        R[i] = p;
+    }
+    free(C);
+}
+
+void hypergraph_build_degree_order(hypergraph *g)
+{
+    if (g->Vo == NULL)
+    {
+        g->Vo = malloc(sizeof(int) * g->n);
+        g->Vod = malloc(sizeof(int) * g->n);
+        g->Eo = malloc(sizeof(int) * g->m);
+        g->Eod = malloc(sizeof(int) * g->m);
+        g->Vr = malloc(sizeof(int) * g->n);
+        g->Er = malloc(sizeof(int) * g->m);
+    }
+
+    degree_order(g->Vd, g->n, g->Vo, g->Vod, g->Vr);
+    degree_order(g->Ed, g->m, g->Eo, g->Eod, g->Er);
+}
+
+void hypergraph_free_degree_order(hypergraph *g)
+{
+    free(g->Vo);
+    free(g->Vod);
+    free(g->Eo);
+    free(g->Eod);
+    free(g->Vr);
+    free(g->Er);
+    g->Vo = NULL;
+    g->Vod = NULL;
+    g->Eo = NULL;
+    g->Eod = NULL;
+    g->Vr = NULL;
+    g->Er = NULL;
+}
+
+static inline int order_prefix(const int *OD, int n, int d)
+{
+    int lo = 0, hi = n;
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (OD[mid] >= d)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+int hypergraph_vertex_order_prefix(hypergraph *g, int d)
+{
+    return order_prefix(g->Vod, g->n, d);
+}
+
+int hypergraph_edge_order_prefix(hypergraph *g, int d)
+{
+    return order_prefix(g->Eod, g->m, d);
+}
+
+// Row x grew to degree d, one more than its degree in the order. It is swapped with the first row of
+// its old degree, which then becomes the last row of degree d
+static void order_raise(int *O, int *OD, int *R, int n, int x, int d)
+{
+    if (OD[R[x]] >= d)
+        return;
+
+    int p = order_prefix(OD, n, d), y = O[p];
+    O[p] = x;
+    O[R[x]] = y;
+    R[y] = R[x];
+    R[x] = p;
+    OD[p] = d;
+}
+
+static inline void insert_sorted(int *A, int n, int x)
+{
+    int p = lower_bound(A, n, x);
+    memmove(A + p + 1, A + p, sizeof(int) * (n - p));
+    A[p] = x;
+}
+
+void hypergraph_add_vertex_to_edge(hypergraph *g, int u, int e)
+{
+    hypergraph_reserve_vertex(g, u, g->Vd[u] + 1);
+    hypergraph_reserve_edge(g, e, g->Ed[e] + 1);
+    hypergraph_clean_vertex(g, u);
+    hypergraph_clean_edge(g, e);
+
+    insert_sorted(g->V[u], g->Vd[u]++, e);
+    insert_sorted(g->E[e], g->Ed[e]++, u);
+    if (g->lazy > 0)
+    {
+        g->Vl[u] = g->Vd[u];
+        g->El[e] = g->Ed[e];
+    }
+
+    if (g->Vsig != NULL)
+    {
+        g->Vsig[u] |= hypergraph_signature_bit(e);
+        g->Esig[e] |= hypergraph_signature_bit(u);
+    }
+    if (g->Vo != NULL)
+    {
+        order_raise(g->Vo, g->Vod, g->Vr, g->n, u, g->Vd[u]);
+        order_raise(g->Eo, g->Eod, g->Er, g->m, e, g->Ed[e]);
+    }
+}
+
+void hypergraph_log_append(hypergraph *g, int type, int u, int v, int w)
+{
+    if (g->log_size == g->log_cap)
+    {
+        g->log_cap = g->log_cap > 0 ? g->log_cap * 2 : 64;
+        g->log = realloc(g->log, sizeof(hypergraph_log_entry) * g->log_cap);
+    }
+    g->log[g->log_size++] = (hypergraph_log_entry){.type = type, .u = u, .v = v, .w = w};
+}
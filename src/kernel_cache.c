@@ -0,0 +1,48 @@
+#include "kernel_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define KERNEL_CACHE_VERSION 2
+
+static void kernel_cache_path(char *path, size_t size, unsigned long long key, const char *pipeline)
+{
+    snprintf(path, size, "%s/%016llx.%s.v%d.hgb", getenv("HG_KERNEL_CACHE"), key, pipeline, KERNEL_CACHE_VERSION);
+}
+
+int kernel_cache_enabled()
+{
+    char *dir = getenv("HG_KERNEL_CACHE");
+    return dir != NULL && dir[0] != '\0';
+}
+
+hypergraph *kernel_cache_load(unsigned long long key, const char *pipeline)
+{
+    if (!kernel_cache_enabled())
+        return NULL;
+
+    char path[4096];
+    kernel_cache_path(path, sizeof(path), key, pipeline);
+    if (access(path, R_OK) != 0)
+        return NULL;
+
+    return hypergraph_load_snapshot(path);
+}
+
+void kernel_cache_store(unsigned long long key, const char *pipeline, hypergraph *g)
+{
+    if (!kernel_cache_enabled())
+        return;
+
+    char path[4096], tmp[4160];
+    kernel_cache_path(path, sizeof(path), key, pipeline);
+
+    // Write to a private file first so concurrent runs never see a partial entry
+    snprintf(tmp, sizeof(tmp), "%s.%d.tmp", path, (int)getpid());
+    if (!hypergraph_write_snapshot(g, tmp) || rename(tmp, path) != 0)
+    {
+        fprintf(stderr, "Failed to store kernel in %s\n", path);
+        remove(tmp);
+    }
+}
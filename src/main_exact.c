@@ -8,13 +8,17 @@
 #include "hs_reducer.h"
 #include "hs_reductions.h"
 #include "hs_reduction_to_mwis.h"
+#include "kernel_cache.h"
+#include "small_solver.h"
 
 #include <time.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <omp.h>
 
 double t_total = 0.0;
+double t_start = 0.0;
 
 double get_wtime() {
     struct timespec tp;
@@ -100,27 +104,76 @@ int get_max_v_deg(hypergraph *hg)
     return max_v_deg;
 }
 
+// Returns 1 if the reductions finished before the time limit
+int reduce_hg(hypergraph *hg)
+{
+    // Reductions share 80 seconds from the start of the program. Past that, hs_reducer_run only removes
+    // the degree one vertices, so components split off late are not reduced for another full call
+    double tl = 80.0 - (get_wtime() - t_start);
+    if (tl < 0.0)
+        tl = 0.0;
+    return hs_reducer_run(hg, hs_reducer_mode_from_env(), tl, 0);
+}
+
+// Replay the reduction log of hg on a solution given as a list of vertices, returns the new size
+long long lift_hg_solution(hypergraph *hg, int **sol, long long HS)
+{
+    if (hg->log_size == 0)
+        return HS;
+
+    int *X = calloc(hg->n, sizeof(int));
+    for (long long i = 0; i < HS; i++)
+        X[(*sol)[i]] = 1;
+    hs_reducer_lift_solution(hg, X);
+
+    HS = 0;
+    for (int u = 0; u < hg->n; u++)
+        HS += X[u];
+    *sol = realloc(*sol, sizeof(int) * (HS > 0 ? HS : 1));
+    HS = 0;
+    for (int u = 0; u < hg->n; u++)
+        if (X[u])
+            (*sol)[HS++] = u;
+
+    free(X);
+    return HS;
+}
+
+long long solve_hg(hypergraph *hg, bool is_one_component, int **sol);
+
+// Sort by decreasing size, the entries are packed as size << 32 | index
+int compare_component_size(const void *a, const void *b) {
+    long long x = *(const long long *) a, y = *(const long long *) b;
+    return (x < y) - (x > y);
+}
+
+// Solve every component as its own task, largest first. Outside a parallel region the tasks run
+// right away, one after the other
+void solve_components(hypergraph **components, int n_components, int **comp_sol, int *comp_sol_size) {
+    long long *order = (long long *) malloc(n_components * sizeof(long long));
+    for (int i = 0; i < n_components; i++) {
+        order[i] = ((long long) (components[i]->n + components[i]->m) << 32) | i;
+    }
+    qsort(order, n_components, sizeof(long long), compare_component_size);
+
+    for (int k = 0; k < n_components; k++) {
+        int i = (int) (order[k] & 0xFFFFFFFF);
+#pragma omp task firstprivate(i)
+        comp_sol_size[i] = solve_hg(components[i], true, &comp_sol[i]);
+    }
+#pragma omp taskwait
+
+    free(order);
+}
+
 long long solve_hg(hypergraph *hg, bool is_one_component, int **sol)
 {
     if (is_one_component)
     {
 
         // The hypergraph is one component so solve it
-        int rc = 1;
-        double tl = 80.0;
-        while (rc > 0)
-        {
-            rc = 0;
-            rc += hs_reductions_degree_one_rule(hg, tl - get_wtime());
-            rc += hs_reductions_edge_domination(hg, tl - get_wtime());
-            rc += hs_reductions_vertex_domination(hg, tl - get_wtime());
-        }
-        rc = 1;
-        while (rc > 0)
-        {
-            rc = 0;
-            rc += hs_reductions_degree_one_rule(hg, 10.0);
-        }
+        long long may_split = hg->may_split;
+        reduce_hg(hg);
 
         if (hg->n == 1 && hg->m == 1)
         {
@@ -135,13 +188,16 @@ long long solve_hg(hypergraph *hg, bool is_one_component, int **sol)
         }
 
         long long HS = 0;
-        if (are_multiple_components(hg))
+        // Only look for components if a reduction could have split the graph
+        if (hg->may_split != may_split && are_multiple_components(hg))
         {
             HS = solve_hg(hg, false, sol);
         }
         else
         {
-            if (get_max_e_deg(hg) <= 2 && false)
+            // Acyclic and small components are solved directly, without going through the MaxSAT solver
+            HS = small_solver_solve_hitting_set(hg, sol);
+            if (HS < 0 && get_max_e_deg(hg) <= 2 && false)
             {
                 double t0 = get_wtime();
                 HS = mwis_solve_hg(hg, sol, 0);
@@ -153,14 +209,19 @@ long long solve_hg(hypergraph *hg, bool is_one_component, int **sol)
                     // printf("mwis solving a hg with %d vertices (max deg=%d) and %d edges (max deg=%d) in %f sec\n", hg->n, max_v_deg, hg->m, max_e_deg, t1 - t0);
                 }
             }
-            else
+            else if (HS < 0)
             {
 
-                double t0 = get_wtime();
-                HS = maxsat_solve_hitting_set(hg, sol);
-                // HS = maxsat_solve_hitting_set_implicit(hg, sol);
-                double t1 = get_wtime();
-                t_total += t1 - t0;
+                // UWrMaxSat keeps global state, so only one component is given to it at a time
+                double t0, t1;
+#pragma omp critical(maxsat)
+                {
+                    t0 = get_wtime();
+                    HS = maxsat_solve_hitting_set(hg, sol);
+                    // HS = maxsat_solve_hitting_set_implicit(hg, sol);
+                    t1 = get_wtime();
+                    t_total += t1 - t0;
+                }
                 if (hg->n > 100)
                 {
                     int max_v_deg = get_max_v_deg(hg);
@@ -169,7 +230,7 @@ long long solve_hg(hypergraph *hg, bool is_one_component, int **sol)
                 }
             }
         }
-        return HS;
+        return lift_hg_solution(hg, sol, HS);
     }
     else
     {
@@ -183,7 +244,11 @@ long long solve_hg(hypergraph *hg, bool is_one_component, int **sol)
         translation_table **edge_tt = NULL;
         int **comp_sol = NULL;
         int *comp_sol_size = NULL;
-        hypergraph **components = find_connected_components(hg, &n_components, &vertex_tt, &edge_tt);
+        int *comp_rows = NULL;
+        hypergraph **components = find_connected_components(hg, &n_components, &vertex_tt, &edge_tt, &comp_rows);
+
+        // The components hold their own copy of the rows, and lifting the solution only needs the log
+        hypergraph_free_rows(hg);
 
         double t1 = get_wtime();
 
@@ -197,9 +262,18 @@ long long solve_hg(hypergraph *hg, bool is_one_component, int **sol)
         comp_sol      = (int **) malloc(n_components * sizeof(int *));
         comp_sol_size = (int *) malloc(n_components * sizeof(int));
 
+        // The first split starts the threads, components found inside a task become more tasks. A single
+        // component is solved directly, so its reductions can still use every thread
+        if (n_components > 1 && !omp_in_parallel()) {
+#pragma omp parallel
+#pragma omp single
+            solve_components(components, n_components, comp_sol, comp_sol_size);
+        } else {
+            solve_components(components, n_components, comp_sol, comp_sol_size);
+        }
+
         long long HS = 0;
         for (int  i  = 0; i < n_components; i++) {
-            comp_sol_size[i] = solve_hg(components[i], true, &comp_sol[i]);
             HS += comp_sol_size[i];
         }
 
@@ -219,6 +293,7 @@ long long solve_hg(hypergraph *hg, bool is_one_component, int **sol)
             free(comp_sol[i]);
         }
         free(components);
+        free(comp_rows);
         free(vertex_tt);
         free(edge_tt);
         free(comp_sol);
@@ -358,19 +433,54 @@ long long solve_hg(hypergraph *hg, bool is_one_component, int **sol)
 
 int main(int argc, char **argv) {
     double t0 = get_wtime();
+    t_start = t0;
 
     // FILE *f = fopen(argv[1], "r");
     // hypergraph *hg = hypergraph_parse(f);
     // fclose(f);
 
-    hypergraph *hg = hypergraph_parse(stdin);
+    hypergraph_input *in = hypergraph_input_read(stdin);
 
-    hypergraph_sort(hg);
+    // A cached kernel for the same input and reduction engine replaces parsing and the reductions
+    unsigned long long key = 0;
+    char pipeline[64];
+    snprintf(pipeline, sizeof(pipeline), "exact-%s", hs_reducer_mode_name(hs_reducer_mode_from_env()));
+    hypergraph *hg = NULL;
+    if (kernel_cache_enabled())
+    {
+        key = hypergraph_input_hash(in);
+        hg = kernel_cache_load(key, pipeline);
+    }
+
+    if (hg == NULL)
+    {
+        hg = hypergraph_parse_input(in);
+        if (hg == NULL)
+        {
+            fprintf(stderr, "Failed to read the input\n");
+            hypergraph_input_free(in);
+            return 1;
+        }
+
+        hypergraph_sort(hg);
+
+        // Store the sorted hypergraph so that later runs can read the snapshot instead
+        char *snapshot = getenv("HG_WRITE_SNAPSHOT");
+        if (snapshot != NULL && !hypergraph_write_snapshot(hg, snapshot))
+            fprintf(stderr, "Failed to write snapshot to %s\n", snapshot);
+
+        // The whole graph is reduced once before it is split, so a cached kernel is exactly what an
+        // uncached run solves. A kernel cut short by the time limit depends on timing and is not stored
+        if (reduce_hg(hg))
+            kernel_cache_store(key, pipeline, hg);
+    }
+    hypergraph_input_free(in);
 
     long long HS   = 0;
     int       *sol = NULL;
 
     HS = solve_hg(hg, false, &sol);
+    HS = lift_hg_solution(hg, &sol, HS);
 
     printf("%lld\n", HS);
     for (int i = 0; i < HS; ++i) {
@@ -7,7 +7,9 @@
 #include "local_search.h"
 #include "local_search_hs.h"
 #include "hs_reductions.h"
+#include "hs_reducer.h"
 #include "simulated_annealing.h"
+#include "kernel_cache.h"
 
 #include <time.h>
 #include <stdio.h>
@@ -62,27 +64,47 @@ int main(int argc, char **argv)
     action.sa_handler = term;
     sigaction(SIGTERM, &action, NULL);
 
-    hypergraph *hg = hypergraph_parse(stdin);
+    hypergraph_input *in = hypergraph_input_read(stdin);
 
-    hypergraph_sort(hg);
+    // A cached kernel for the same input and reduction engine replaces parsing and the reductions
+    unsigned long long key = 0;
+    char pipeline[64];
+    snprintf(pipeline, sizeof(pipeline), "heuristic-%s", hs_reducer_mode_name(hs_reducer_mode_from_env()));
+    hypergraph *hg = NULL;
+    if (kernel_cache_enabled())
+    {
+        key = hypergraph_input_hash(in);
+        hg = kernel_cache_load(key, pipeline);
+    }
+    int cached = hg != NULL;
+
+    if (!cached)
+    {
+        hg = hypergraph_parse_input(in);
+        if (hg == NULL)
+        {
+            fprintf(stderr, "Failed to read the input\n");
+            hypergraph_input_free(in);
+            return 1;
+        }
+
+        hypergraph_sort(hg);
+
+        // Store the sorted hypergraph so that later runs can read the snapshot instead
+        char *snapshot = getenv("HG_WRITE_SNAPSHOT");
+        if (snapshot != NULL && !hypergraph_write_snapshot(hg, snapshot))
+            fprintf(stderr, "Failed to write snapshot to %s\n", snapshot);
+    }
+    hypergraph_input_free(in);
 
     if (!VERBOSE)
         printf("c {\"V_input\":%d,\"E_input\":%d}\n", hg->n, hg->m);
 
-    int rc = 1;
-    double tl = 80.0;
-    while (rc > 0 && tl > (get_wtime() - t0))
-    {
-        rc = 0;
-        rc += hs_reductions_degree_one_rule(hg, tl - (get_wtime() - t0));
-        rc += hs_reductions_edge_domination(hg, tl - (get_wtime() - t0));
-        rc += hs_reductions_vertex_domination(hg, tl - (get_wtime() - t0));
-    }
-    rc = 1;
-    while (rc > 0)
+    if (!cached)
     {
-        rc = 0;
-        rc += hs_reductions_degree_one_rule(hg, 10.0);
+        // A kernel cut short by the time limit depends on timing, so only a finished one is stored
+        if (hs_reducer_run(hg, hs_reducer_mode_from_env(), 80.0 - (get_wtime() - t0), !VERBOSE))
+            kernel_cache_store(key, pipeline, hg);
     }
 
     int nr = 0, mr = 0, md = 0;
@@ -213,7 +235,7 @@ int main(int argc, char **argv)
     }
     else if (mr < 20000 && mr > 0)
     {
-        offset = 0;
+        offset = hs_reducer_lift_offset(hg);
         for (int u = 0; u < hg->n; u++)
         {
             if (hg->Vd[u] == 1)
@@ -262,7 +284,7 @@ int main(int argc, char **argv)
         simulated_annealing_free(sa);
     }
 
-    offset = 0;
+    offset = hs_reducer_lift_offset(hg);
     for (int u = 0; u < hg->n; u++)
     {
         if (hg->Vd[u] == 1)
@@ -312,12 +334,18 @@ int main(int argc, char **argv)
 
     if (!VERBOSE)
     {
+        int *HS = malloc(sizeof(int) * hg->n);
+        for (int u = 0; u < hg->n; u++)
+            HS[u] = hg->Vd[u] == 1 || (hg->Vd[u] > 0 && ls_hs->best_hitting_set[FM_HS[u]]);
+        hs_reducer_lift_solution(hg, HS);
+
         printf("%12lld\n", ls_hs->best_cost + offset);
         for (int u = 0; u < hg->n; u++)
         {
-            if (hg->Vd[u] == 1 || (hg->Vd[u] > 0 && ls_hs->best_hitting_set[FM_HS[u]]))
+            if (HS[u])
                 printf("%d\n", u + 1);
         }
+        free(HS);
     }
 
     free(FM_HS);
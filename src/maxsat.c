@@ -2,6 +2,7 @@
 #include "ipamir.h"
 #include "mwis_reductions.h"
 #include "maxsat.h"
+#include "set_ops.h"
 
 #include <stdio.h>
 #include <stdint.h>
@@ -9,16 +10,10 @@
 #include <string.h>
 
 int is_neighbor(graph *g, node_id u, node_id v) {
-    // Binary search for neighbor v in u's adjacency list
-    node_id *neighbors = g->V[u];
-    long long lo = 0, hi = g->D[u] - 1;
-    while (lo <= hi) {
-        long long mid = (lo + hi) / 2;
-        if (neighbors[mid] == v) return 1;
-        if (neighbors[mid] < v) lo = mid + 1;
-        else hi = mid - 1;
-    }
-    return 0;
+    // Branch free search for neighbor v in u's adjacency list, node_id is defined by the reduction library
+    if (sizeof(node_id) == sizeof(int))
+        return set_ops_contains((const int *)g->V[u], g->D[u], v);
+    return set_ops_contains_64((const long long *)g->V[u], g->D[u], v);
 }
 
 int grow_clique(graph *g, node_id start, int *used, node_id *clique, int max_size) {
@@ -0,0 +1,174 @@
+#include "set_ops.h"
+
+#include <immintrin.h>
+
+typedef int (*set_ops_func)(const int *A, int a, const int *B, int b);
+
+// For a much smaller than b, search for each element of A with exponential steps through B
+static int subset_gallop(const int *A, int a, const int *B, int b)
+{
+    int j = 0;
+    for (int i = 0; i < a; i++)
+    {
+        int s = 1;
+        while (j + s < b && B[j + s] < A[i])
+            s *= 2;
+
+        int lo = j, hi = j + s < b ? j + s : b - 1;
+        while (lo < hi)
+        {
+            int mid = (lo + hi) / 2;
+            if (B[mid] < A[i])
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        if (lo >= b || B[lo] != A[i])
+            return 0;
+        j = lo + 1;
+    }
+    return 1;
+}
+
+/*
+    Vector kernels
+
+    A block of A is compared against every rotation of a block of B, which finds all equal pairs
+    between the two blocks. The block with the smaller last element is then replaced by the next one.
+    found marks the elements of the current A block that were matched so far, and is used to finish
+    the last partial blocks of a subset test with a scalar merge. The rotations make wider vectors no cheaper per
+    element, and 16 lane AVX-512 blocks measured slower than AVX2, so only AVX2 kernels are provided.
+*/
+
+// Finish a merge after the vector loop, skipping the elements of A marked in found
+static inline int finish_subset(const int *A, int a, int i, const int *B, int b, int j, unsigned int found)
+{
+    for (; i < a; i++, found >>= 1)
+    {
+        if (found & 1)
+            continue;
+
+        while (j < b && B[j] < A[i])
+            j++;
+        if (j == b || B[j] != A[i])
+            return 0;
+        j++;
+    }
+    return 1;
+}
+
+__attribute__((target("avx2"))) static inline unsigned int match_avx2(__m256i va, __m256i vb)
+{
+    const __m256i rot = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+    __m256i m = _mm256_cmpeq_epi32(va, vb);
+    for (int k = 1; k < 8; k++)
+    {
+        vb = _mm256_permutevar8x32_epi32(vb, rot);
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi32(va, vb));
+    }
+    return _mm256_movemask_ps(_mm256_castsi256_ps(m));
+}
+
+__attribute__((target("avx2"))) static int subset_avx2(const int *A, int a, const int *B, int b)
+{
+    int i = 0, j = 0;
+    unsigned int found = 0;
+    while (i + 8 <= a && j + 8 <= b)
+    {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(A + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(B + j));
+        found |= match_avx2(va, vb);
+
+        int x = A[i + 7], y = B[j + 7];
+        if (x <= y)
+        {
+            if (found != 0xFF)
+                return 0;
+            found = 0;
+            i += 8;
+        }
+        if (y <= x)
+            j += 8;
+    }
+    return finish_subset(A, a, i, B, b, j, found);
+}
+
+__attribute__((target("avx2"))) static int disjoint_avx2(const int *A, int a, const int *B, int b)
+{
+    int i = 0, j = 0;
+    while (i + 8 <= a && j + 8 <= b)
+    {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(A + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(B + j));
+        if (match_avx2(va, vb))
+            return 0;
+
+        int x = A[i + 7], y = B[j + 7];
+        i += (x <= y) * 8;
+        j += (y <= x) * 8;
+    }
+    return set_ops_disjoint_scalar(A + i, a - i, B + j, b - j);
+}
+
+// Runtime dispatch, the scalar kernels are used until set_ops_init has run
+
+static set_ops_func subset_impl = set_ops_subset_scalar;
+static set_ops_func disjoint_impl = set_ops_disjoint_scalar;
+
+__attribute__((constructor)) static void set_ops_init()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        subset_impl = subset_avx2;
+        disjoint_impl = disjoint_avx2;
+    }
+}
+
+int set_ops_subset_large(const int *A, int a, const int *B, int b)
+{
+    if (b < a)
+        return 0;
+    if (b / 32 > a)
+        return subset_gallop(A, a, B, b);
+    return subset_impl(A, a, B, b);
+}
+
+int set_ops_disjoint_large(const int *A, int a, const int *B, int b)
+{
+    return disjoint_impl(A, a, B, b);
+}
+
+// Branch free binary search down to a short range, which is then scanned without early exits
+int set_ops_contains(const int *A, int n, int x)
+{
+    const int *s = A, *end = A + n;
+    while (n > SET_OPS_SMALL)
+    {
+        int h = n / 2;
+        s += (s[h - 1] < x) * h;
+        n -= h;
+    }
+
+    int f = 0;
+    for (int i = 0; i <= n && s + i < end; i++)
+        f |= s[i] == x;
+    return f;
+}
+
+int set_ops_contains_64(const long long *A, long long n, long long x)
+{
+    const long long *s = A, *end = A + n;
+    while (n > SET_OPS_SMALL)
+    {
+        long long h = n / 2;
+        s += (s[h - 1] < x) * h;
+        n -= h;
+    }
+
+    int f = 0;
+    for (long long i = 0; i <= n && s + i < end; i++)
+        f |= s[i] == x;
+    return f;
+}
@@ -1,4 +1,5 @@
 #include "simulated_annealing.h"
+#include "set_ops.h"
 
 #include <time.h>
 #include <stdlib.h>
@@ -28,6 +29,14 @@ simulated_annealing *simulated_annealing_init(graph_csr *g, unsigned int seed)
     sa->cover_count = malloc(sizeof(int) * g->m);
     sa->one_tight = malloc(sizeof(int) * g->m);
 
+    int md = 1;
+    for (int u = 0; u < g->n; u++)
+    {
+        if (g->V[u + 1] - g->V[u] > md)
+            md = g->V[u + 1] - g->V[u];
+    }
+    sa->tight_edges = malloc(sizeof(int) * md);
+
     sa->k = 999999999ll;
 
     sa->seed = seed;
@@ -48,6 +57,7 @@ void simulated_annealing_free(simulated_annealing *sa)
     free(sa->score);
     free(sa->cover_count);
     free(sa->one_tight);
+    free(sa->tight_edges);
 
     free(sa);
 }
@@ -200,27 +210,20 @@ int simulated_annealing_one_two_swap(graph_csr *g, simulated_annealing *sa, int
         for (int i = 0; i < n && !found; i++)
         {
             int v1 = T[i];
+
+            // A pair is invalid if both vertices are in an edge with cover count 2, so only those edges of v1 are kept
+            int t = 0;
+            for (int k = g->V[v1]; k < g->V[v1 + 1]; k++)
+            {
+                if (sa->cover_count[g->E[k]] == 2)
+                    sa->tight_edges[t++] = g->E[k];
+            }
+
             for (int j = i + 1; j < n && !found; j++)
             {
                 int v2 = T[j];
 
-                int i1 = g->V[v1], i2 = g->V[v2];
-                int valid_pair = 1;
-                while (i1 < g->V[v1 + 1] && i2 < g->V[v2 + 1] && valid_pair)
-                {
-                    if (g->E[i1] < g->E[i2])
-                        i1++;
-                    else if (g->E[i1] > g->E[i2])
-                        i2++;
-                    else
-                    {
-                        if (sa->cover_count[g->E[i1]] == 2)
-                            valid_pair = 0;
-
-                        i1++;
-                        i2++;
-                    }
-                }
+                int valid_pair = set_ops_disjoint(sa->tight_edges, t, g->E + g->V[v2], g->V[v2 + 1] - g->V[v2]);
 
                 if (valid_pair)
                 {
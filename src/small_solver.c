@@ -0,0 +1,280 @@
+#include "small_solver.h"
+
+#include <stdlib.h>
+
+#define INF (1LL << 40)
+
+/*
+    Dynamic programming over the incidence forest, nodes 0 to n - 1 are the vertices and n to n + m - 1
+    the edges. Every tree is rooted in a vertex, so each edge has the parent vertex and its child vertices.
+
+    For a vertex, A is the cost of its subtree with the vertex taken and B without it. For an edge, A is
+    the cost of its subtree when the parent vertex already hits it, and B when a child has to.
+*/
+static long long solve_forest(hypergraph *g, int **res)
+{
+    int n = g->n, N = g->n + g->m;
+    int *P = malloc(sizeof(int) * N);     // Parent node, -1 for roots and -2 before the node is reached
+    int *O = malloc(sizeof(int) * N);     // Nodes in breadth first order
+    int *C = malloc(sizeof(int) * N);     // For an edge, the child that is cheapest to take
+    long long *A = malloc(sizeof(long long) * N);
+    long long *B = malloc(sizeof(long long) * N);
+
+    for (int i = 0; i < N; i++)
+        P[i] = -2;
+
+    int k = 0, cycle = 0;
+    for (int r = 0; r < n && !cycle; r++)
+    {
+        if (g->Vd[r] == 0 || P[r] != -2)
+            continue;
+
+        P[r] = -1;
+        O[k++] = r;
+        for (int h = k - 1; h < k && !cycle; h++)
+        {
+            int x = O[h];
+            int d = x < n ? g->Vd[x] : g->Ed[x - n];
+            const int *R = x < n ? g->V[x] : g->E[x - n];
+            for (int i = 0; i < d; i++)
+            {
+                int y = x < n ? R[i] + n : R[i];
+                if (y == P[x])
+                    continue;
+
+                // A node reached twice closes a cycle
+                if (P[y] != -2)
+                {
+                    cycle = 1;
+                    break;
+                }
+                P[y] = x;
+                O[k++] = y;
+            }
+        }
+    }
+
+    long long r = -1;
+    if (!cycle)
+    {
+        // Children are handled before their parents. For an edge, B holds the smallest extra cost of
+        // taking a child until the edge itself is reached
+        for (int i = 0; i < k; i++)
+        {
+            int x = O[i];
+            A[x] = x < n ? 1 : 0;
+            B[x] = x < n ? 0 : INF;
+        }
+        for (int i = k - 1; i >= 0; i--)
+        {
+            int x = O[i], p = P[x];
+            if (x < n)
+            {
+                if (p < 0)
+                    continue;
+
+                long long c = A[x] < B[x] ? A[x] : B[x];
+                A[p] += c;
+                if (A[x] - c < B[p])
+                {
+                    B[p] = A[x] - c;
+                    C[p] = x;
+                }
+            }
+            else
+            {
+                if (B[x] < INF)
+                    B[x] += A[x];
+                A[p] += A[x];
+                B[p] += B[x];
+                if (B[p] > INF)
+                    B[p] = INF;
+            }
+        }
+
+        // Going down, S marks the vertices taken and the edges that a child has to hit
+        int *S = calloc(N, sizeof(int));
+        r = 0;
+        for (int i = 0; i < k; i++)
+        {
+            int x = O[i], p = P[x];
+            if (x >= n)
+                S[x] = !S[p];
+            else if (p >= 0 && S[p] && C[p] == x)
+                S[x] = 1;
+            else
+                S[x] = A[x] <= B[x];
+            r += x < n && S[x];
+        }
+
+        *res = malloc(sizeof(int) * (r > 0 ? r : 1));
+        int s = 0;
+        for (int u = 0; u < n; u++)
+            if (S[u])
+                (*res)[s++] = u;
+        free(S);
+    }
+
+    free(P);
+    free(O);
+    free(C);
+    free(A);
+    free(B);
+    return r;
+}
+
+typedef struct
+{
+    int m;
+    unsigned long long *E; // Edges as masks over the local vertex ids, smallest first
+    unsigned long long best_set;
+    int best;
+    long long nodes;
+} branch_and_bound;
+
+static int compare_popcount(const void *a, const void *b)
+{
+    int x = __builtin_popcountll(*(const unsigned long long *)a);
+    int y = __builtin_popcountll(*(const unsigned long long *)b);
+    return (x > y) - (x < y);
+}
+
+/*
+    S is the set taken so far and F the vertices that may no longer be taken. The unhit edge with the
+    fewest allowed vertices is branched on, where each branch takes one of them and forbids the ones
+    taken in the branches before it. Unhit edges with pairwise disjoint allowed vertices each need a
+    vertex of their own, which gives the lower bound.
+*/
+static void branch(branch_and_bound *b, unsigned long long S, unsigned long long F, int k)
+{
+    if (++b->nodes > SMALL_SOLVER_NODE_LIMIT)
+        return;
+
+    int lb = 0, pick_c = 65;
+    unsigned long long U = 0, pick = 0;
+    for (int i = 0; i < b->m; i++)
+    {
+        if (b->E[i] & S)
+            continue;
+
+        unsigned long long a = b->E[i] & ~F;
+        if (a == 0)
+            return;
+
+        int c = __builtin_popcountll(a);
+        if (c < pick_c)
+        {
+            pick_c = c;
+            pick = a;
+        }
+        if ((a & U) == 0)
+        {
+            U |= a;
+            lb++;
+        }
+    }
+
+    if (pick == 0)
+    {
+        if (k < b->best)
+        {
+            b->best = k;
+            b->best_set = S;
+        }
+        return;
+    }
+    if (k + lb >= b->best)
+        return;
+
+    while (pick != 0 && b->nodes <= SMALL_SOLVER_NODE_LIMIT)
+    {
+        unsigned long long x = pick & -pick;
+        pick ^= x;
+        branch(b, S | x, F, k + 1);
+        F |= x;
+    }
+}
+
+static long long solve_branch_and_bound(hypergraph *g, int **res)
+{
+    // Local ids for the vertices with edges
+    int *id = malloc(sizeof(int) * (g->n > 0 ? g->n : 1));
+    int R[SMALL_SOLVER_MAX_N];
+    int n = 0;
+    for (int u = 0; u < g->n; u++)
+    {
+        id[u] = -1;
+        if (g->Vd[u] == 0)
+            continue;
+        if (n == SMALL_SOLVER_MAX_N)
+        {
+            free(id);
+            return -1;
+        }
+        R[n] = u;
+        id[u] = n++;
+    }
+
+    branch_and_bound b;
+    b.m = 0;
+    b.E = malloc(sizeof(unsigned long long) * (g->m > 0 ? g->m : 1));
+    for (int e = 0; e < g->m; e++)
+    {
+        if (g->Ed[e] == 0)
+            continue;
+
+        unsigned long long x = 0;
+        for (int i = 0; i < g->Ed[e]; i++)
+            x |= 1ULL << id[g->E[e][i]];
+        b.E[b.m++] = x;
+    }
+    free(id);
+    qsort(b.E, b.m, sizeof(unsigned long long), compare_popcount);
+
+    // Greedy start, repeatedly taking the vertex in the most unhit edges
+    b.best_set = 0;
+    b.best = 0;
+    for (;;)
+    {
+        int cnt[SMALL_SOLVER_MAX_N] = {0};
+        int any = 0;
+        for (int i = 0; i < b.m; i++)
+        {
+            if (b.E[i] & b.best_set)
+                continue;
+            any = 1;
+            for (unsigned long long x = b.E[i]; x != 0; x &= x - 1)
+                cnt[__builtin_ctzll(x)]++;
+        }
+        if (!any)
+            break;
+
+        int v = 0;
+        for (int i = 1; i < n; i++)
+            if (cnt[i] > cnt[v])
+                v = i;
+        b.best_set |= 1ULL << v;
+        b.best++;
+    }
+
+    b.nodes = 0;
+    branch(&b, 0, 0, 0);
+    free(b.E);
+
+    if (b.nodes > SMALL_SOLVER_NODE_LIMIT)
+        return -1;
+
+    *res = malloc(sizeof(int) * (b.best > 0 ? b.best : 1));
+    int s = 0;
+    for (unsigned long long x = b.best_set; x != 0; x &= x - 1)
+        (*res)[s++] = R[__builtin_ctzll(x)];
+    return b.best;
+}
+
+long long small_solver_solve_hitting_set(hypergraph *hg, int **res)
+{
+    long long r = solve_forest(hg, res);
+    if (r < 0)
+        r = solve_branch_and_bound(hg, res);
+    return r;
+}